@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/base64.hpp"
+
+namespace {
+namespace base64 = cplib_initializers::common::base64;
+using base64::Kernel;
+using Clock = std::chrono::steady_clock;
+
+// The previous encoder: a vector per triplet and a growing string.
+auto encode_previous(const std::vector<std::uint8_t> &input) -> std::string {
+  std::string output;
+  output.reserve((input.size() / 3 + 2) * 4);
+  const auto encode_triplet = [&](std::uint8_t a, std::uint8_t b, std::uint8_t c) {
+    const std::uint32_t bits = (a << 16) | (b << 8) | c;
+    return std::array{base64::detail::ALPHABET[(bits >> 18) & 0x3f],
+                      base64::detail::ALPHABET[(bits >> 12) & 0x3f],
+                      base64::detail::ALPHABET[(bits >> 6) & 0x3f],
+                      base64::detail::ALPHABET[bits & 0x3f]};
+  };
+  for (std::size_t i = 0; i + 3 <= input.size(); i += 3) {
+    const auto first = input.begin() + static_cast<std::ptrdiff_t>(i);
+    const auto triplet = std::vector<std::uint8_t>(first, first + 3);
+    std::ranges::copy(encode_triplet(triplet[0], triplet[1], triplet[2]),
+                      std::back_inserter(output));
+  }
+  return output;
+}
+
+// The previous decoder: a validation pass, then a lookup per character and a growing vector.
+auto decode_previous(std::string_view encoded) -> std::optional<std::vector<std::uint8_t>> {
+  const auto &table = base64::detail::DECODE_TABLE;
+  if (!std::ranges::all_of(encoded, [&](char c) {
+        return table[static_cast<unsigned char>(c)] != base64::detail::INVALID;
+      })) {
+    return std::nullopt;
+  }
+  std::vector<std::uint8_t> output;
+  output.reserve(encoded.size() / 4 * 3);
+  for (std::size_t i = 0; i + 4 <= encoded.size(); i += 4) {
+    std::uint32_t bits = 0;
+    for (std::size_t j = 0; j < 4; ++j) {
+      bits = (bits << 6) | table[static_cast<unsigned char>(encoded[i + j])];
+    }
+    const std::array<std::uint8_t, 3> bytes{static_cast<std::uint8_t>(bits >> 16),
+                                            static_cast<std::uint8_t>(bits >> 8),
+                                            static_cast<std::uint8_t>(bits)};
+    std::ranges::copy(bytes, std::back_inserter(output));
+  }
+  return output;
+}
+
+// Best of `repetitions` runs of `run`, in seconds.
+template <class Run>
+auto best_time(int repetitions, Run run) -> double {
+  auto best = 1e9;
+  for (int i = 0; i < repetitions; ++i) {
+    const auto start = Clock::now();
+    run();
+    best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+  }
+  return best;
+}
+}  // namespace
+
+// Encode and decode throughput of each Base64 kernel, in GB/s of raw data.
+auto main(int argc, char **argv) -> int {
+  const std::size_t mib = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+  if (mib == 0) {
+    std::fputs("usage: base64 [<message_mib>]\n", stderr);
+    return EXIT_FAILURE;
+  }
+  constexpr int REPETITIONS = 5;
+
+  // A multiple of 3 bytes, so that the previous implementation needs no padding.
+  const auto size = mib * (1 << 20) / 3 * 3;
+  std::vector<std::uint8_t> data(size);
+  std::mt19937 rng(1);
+  for (auto &byte : data) byte = static_cast<std::uint8_t>(rng());
+  std::string encoded(base64::encoded_size(size), '\0');
+  std::vector<std::uint8_t> decoded(size);
+  base64::encode(data.data(), size, encoded.data(), Kernel::SCALAR);
+
+  const auto gb = static_cast<double>(size) / 1e9;
+  std::printf("%-10s %14s %14s\n", "kernel", "encode(GB/s)", "decode(GB/s)");
+  {
+    std::size_t sink = 0;
+    const auto encode = best_time(REPETITIONS, [&] { sink += encode_previous(data).size(); });
+    const auto decode = best_time(REPETITIONS, [&] { sink += decode_previous(encoded)->size(); });
+    std::printf("%-10s %14.2f %14.2f\n", "previous", gb / encode, gb / decode);
+    if (sink == 0) return EXIT_FAILURE;
+  }
+
+  struct Mode {
+    std::string_view name;
+    Kernel kernel;
+  };
+  for (const auto &mode : {Mode{"scalar", Kernel::SCALAR}, Mode{"sse4.1", Kernel::SSE41},
+                           Mode{"avx2", Kernel::AVX2}}) {
+    if (!base64::supported(mode.kernel)) continue;
+    const auto encode = best_time(
+        REPETITIONS, [&] { base64::encode(data.data(), size, encoded.data(), mode.kernel); });
+    const auto decode =
+        best_time(REPETITIONS, [&] { base64::decode(encoded, decoded.data(), mode.kernel); });
+    if (decoded != data) {
+      std::fprintf(stderr, "%.*s: round trip mismatch\n", static_cast<int>(mode.name.size()),
+                   mode.name.data());
+      return EXIT_FAILURE;
+    }
+    std::printf("%-10.*s %14.2f %14.2f\n", static_cast<int>(mode.name.size()), mode.name.data(),
+                gb / encode, gb / decode);
+  }
+}
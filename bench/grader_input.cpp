@@ -0,0 +1,109 @@
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "luogu/checker_grader_interaction.hpp"
+
+namespace {
+namespace grader = cplib_initializers::luogu::checker_grader_interaction;
+using Clock = std::chrono::steady_clock;
+
+// The previous implementation: read the whole file into memory, then write it out.
+auto pipe_buffered(const std::string &path, int out_fd) -> void {
+  auto *file = std::fopen(path.c_str(), "rb");
+  if (file == nullptr) std::exit(1);
+  std::fseek(file, 0, SEEK_END);
+  const auto size = static_cast<std::size_t>(std::ftell(file));
+  std::fseek(file, 0, SEEK_SET);
+  std::vector<char> buffer(size);
+  if (std::fread(buffer.data(), 1, size, file) != size) std::exit(1);
+  std::fclose(file);
+  auto *out = fdopen(out_fd, "wb");
+  if (std::fwrite(buffer.data(), 1, size, out) != size) std::exit(1);
+  std::fflush(out);
+}
+
+// The checker's implementation: stream the file with `sendfile` in constant memory.
+auto pipe_sendfile(const std::string &path, int out_fd) -> void {
+  const auto in_fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (in_fd < 0 || !grader::detail::send_input(in_fd, out_fd)) std::exit(1);
+  close(in_fd);
+}
+
+struct Result {
+  double seconds;
+  long max_rss_kib;
+};
+
+// Pipe `path` to a reader in this process from a child, the way a checker feeds the program.
+template <class Pipe>
+auto measure(const std::string &path, Pipe pipe_file) -> Result {
+  std::array<int, 2> fds{};
+  if (pipe(fds.data()) != 0) std::exit(1);
+  const auto start = Clock::now();
+  const auto child = fork();
+  if (child == 0) {
+    close(fds[0]);
+    pipe_file(path, fds[1]);
+    _exit(0);
+  }
+  close(fds[1]);
+  std::vector<char> buffer(1 << 16);
+  while (read(fds[0], buffer.data(), buffer.size()) > 0) {
+  }
+  close(fds[0]);
+  rusage usage{};
+  int status = 0;
+  wait4(child, &status, 0, &usage);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) std::exit(1);
+  return {std::chrono::duration<double>(Clock::now() - start).count(), usage.ru_maxrss};
+}
+}  // namespace
+
+// Throughput and peak memory of the Luogu grader checker forwarding a large input to the program.
+auto main(int argc, char **argv) -> int {
+  const std::size_t mib = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 512;
+  if (mib == 0) {
+    std::fputs("usage: grader_input [<input_mib>]\n", stderr);
+    return EXIT_FAILURE;
+  }
+
+  const auto path = "/tmp/cplib-grader-input-" + std::to_string(getpid()) + ".in";
+  {
+    auto *file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) return EXIT_FAILURE;
+    std::string block;
+    while (block.size() < (1 << 20)) block += std::to_string(block.size()) + '\n';
+    block.resize(1 << 20);
+    for (std::size_t i = 0; i < mib; ++i) std::fwrite(block.data(), 1, block.size(), file);
+    std::fclose(file);
+  }
+
+  struct Mode {
+    std::string_view name;
+    Result result;
+  };
+  const std::array modes{
+      Mode{"buffered", measure(path, pipe_buffered)},
+      Mode{"sendfile", measure(path, pipe_sendfile)},
+  };
+
+  std::printf("%-10s %10s %10s %12s %14s\n", "mode", "MiB", "time(s)", "GiB/s", "max rss(MiB)");
+  for (const auto &mode : modes) {
+    std::printf("%-10.*s %10zu %10.3f %12.2f %14.1f\n", static_cast<int>(mode.name.size()),
+                mode.name.data(), mib, mode.result.seconds,
+                static_cast<double>(mib) / 1024.0 / mode.result.seconds,
+                static_cast<double>(mode.result.max_rss_kib) / 1024.0);
+  }
+  unlink(path.c_str());
+}
@@ -0,0 +1,169 @@
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "common/channel.hpp"
+#include "common/placement.hpp"
+
+namespace {
+using cplib_initializers::common::channel::FromUserBuf;
+using cplib_initializers::common::channel::Options;
+using cplib_initializers::common::channel::ToUserBuf;
+namespace placement = cplib_initializers::common::placement;
+using Clock = std::chrono::steady_clock;
+
+// A contestant that answers every line with a line, flushing after each answer.
+[[noreturn]] auto run_contestant(int in, int out) -> void {
+  std::array<char, 4096> buffer{};
+  while (true) {
+    auto size = read(in, buffer.data(), buffer.size());
+    if (size <= 0) _exit(0);
+    for (ssize_t i = 0; i < size; ++i) {
+      if (buffer[i] == '\n' && write(out, "a\n", 2) != 2) _exit(1);
+    }
+  }
+}
+
+struct Result {
+  double mean_us;
+  double p50_us;
+  double p99_us;
+  double max_us;
+};
+
+// Run one ping-pong session. With `contestant_cpu` set, the contestant is pinned there and the
+// interactor placement options are applied, as an initializer would.
+auto run(const Options &options, std::optional<int> contestant_cpu, std::size_t rounds) -> Result {
+  std::array<int, 2> to_contestant{};
+  std::array<int, 2> from_contestant{};
+  if (pipe(to_contestant.data()) != 0 || pipe(from_contestant.data()) != 0) std::exit(1);
+
+  const auto child = fork();
+  if (child == 0) {
+    close(to_contestant[1]);
+    close(from_contestant[0]);
+    if (contestant_cpu.has_value()) placement::apply({.cpu = contestant_cpu}, -1);
+    run_contestant(to_contestant[0], from_contestant[1]);
+  }
+  close(to_contestant[0]);
+  close(from_contestant[1]);
+
+  cpu_set_t original;
+  sched_getaffinity(0, sizeof(original), &original);
+  if (contestant_cpu.has_value()) placement::apply(options.placement, from_contestant[0]);
+
+  std::vector<double> latencies;
+  latencies.reserve(rounds);
+  {
+    ToUserBuf to_user(to_contestant[1], options);
+    FromUserBuf from_user(from_contestant[0], &to_user, options);
+    std::ostream stream(&to_user);
+
+    for (std::size_t i = 0; i < rounds; ++i) {
+      const auto start = Clock::now();
+      stream << "q\n" << std::flush;
+      while (from_user.sbumpc() != '\n') {
+      }
+      latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+  }
+
+  close(to_contestant[1]);
+  close(from_contestant[0]);
+  waitpid(child, nullptr, 0);
+  sched_setaffinity(0, sizeof(original), &original);
+
+  std::ranges::sort(latencies);
+  double total = 0;
+  for (auto latency : latencies) total += latency;
+  return {
+      .mean_us = total / static_cast<double>(latencies.size()),
+      .p50_us = latencies[latencies.size() / 2],
+      .p99_us = latencies[latencies.size() * 99 / 100],
+      .max_us = latencies.back(),
+  };
+}
+
+auto first_allowed_cpu() -> int {
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) return 0;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) return cpu;
+  }
+  return 0;
+}
+
+auto stddev(const std::vector<double> &values) -> double {
+  double mean = 0;
+  for (auto value : values) mean += value;
+  mean /= static_cast<double>(values.size());
+  double sum = 0;
+  for (auto value : values) sum += (value - mean) * (value - mean);
+  return std::sqrt(sum / static_cast<double>(values.size()));
+}
+}  // namespace
+
+auto main(int argc, char **argv) -> int {
+  const std::size_t rounds = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+  const std::size_t repetitions = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5;
+  if (rounds == 0 || repetitions == 0) {
+    std::fputs("usage: ping_pong [<rounds> [<repetitions>]]\n", stderr);
+    return EXIT_FAILURE;
+  }
+
+  struct Mode {
+    std::string_view name;
+    Options options;
+    std::optional<int> contestant_cpu;
+  };
+  const auto cpu = first_allowed_cpu();
+  const std::array modes{
+      Mode{"blocking", Options{}, std::nullopt},
+      Mode{"spin 20us",
+           Options{.spin_budget = std::chrono::microseconds(20), .adaptive_spin = false},
+           std::nullopt},
+      Mode{"spin 50us adaptive", Options{.spin_budget = std::chrono::microseconds(50)},
+           std::nullopt},
+      Mode{"pinned same cpu", Options{.placement = {.cpu = cpu}}, cpu},
+      Mode{"pinned sibling", Options{.placement = {.near_contestant = true}}, cpu},
+      Mode{"pinned sibling spin",
+           Options{.spin_budget = std::chrono::microseconds(50),
+                   .placement = {.near_contestant = true}},
+           cpu},
+  };
+
+  // The spread of the median across repetitions shows how stable a mode is between judge runs.
+  std::printf("%-20s %10s %10s %10s %10s %10s %12s\n", "mode", "rounds", "mean(us)", "p50(us)",
+              "p99(us)", "max(us)", "p50 sd(us)");
+  for (const auto &mode : modes) {
+    std::vector<Result> results;
+    std::vector<double> medians;
+    for (std::size_t i = 0; i < repetitions; ++i) {
+      results.push_back(run(mode.options, mode.contestant_cpu, rounds));
+      medians.push_back(results.back().p50_us);
+    }
+    Result total{};
+    for (const auto &result : results) {
+      total.mean_us += result.mean_us / static_cast<double>(repetitions);
+      total.p50_us += result.p50_us / static_cast<double>(repetitions);
+      total.p99_us += result.p99_us / static_cast<double>(repetitions);
+      total.max_us = std::max(total.max_us, result.max_us);
+    }
+    std::printf("%-20.*s %10zu %10.2f %10.2f %10.2f %10.2f %12.2f\n",
+                static_cast<int>(mode.name.size()), mode.name.data(), rounds, total.mean_us,
+                total.p50_us, total.p99_us, total.max_us, stddev(medians));
+  }
+}
@@ -0,0 +1,159 @@
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "common/server.hpp"
+
+namespace {
+namespace server = cplib_initializers::common::server;
+using Clock = std::chrono::steady_clock;
+
+// Stands in for parsing `inf`: reads every number of the input file.
+auto parse_input(const char *path) -> std::int64_t {
+  std::FILE *file = std::fopen(path, "r");
+  if (file == nullptr) std::exit(1);
+  std::int64_t sum = 0;
+  long long value;
+  while (std::fscanf(file, "%lld", &value) == 1) sum += value;
+  std::fclose(file);
+  return sum;
+}
+
+// The first message of a session, sent as soon as the interactor is ready.
+[[noreturn]] auto greet(std::int64_t sum) -> void {
+  const auto line = std::to_string(sum) + "\n";
+  _exit(write(STDOUT_FILENO, line.data(), line.size()) < 0 ? 1 : 0);
+}
+
+// Wait for the first byte on `fd`, then for the session to end.
+auto await_first_byte(int fd, Clock::time_point start) -> double {
+  char byte;
+  if (read(fd, &byte, 1) != 1) std::exit(1);
+  const auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+  std::array<char, 256> rest{};
+  while (read(fd, rest.data(), rest.size()) > 0) {
+  }
+  close(fd);
+  return elapsed;
+}
+
+// A cold start: exec the interactor, which parses its input before greeting.
+auto cold_start(const std::string &self, const std::string &input) -> double {
+  std::array<int, 2> out{};
+  if (pipe(out.data()) != 0) std::exit(1);
+  const auto start = Clock::now();
+  const auto child = fork();
+  if (child == 0) {
+    dup2(out[1], STDOUT_FILENO);
+    close(out[0]);
+    close(out[1]);
+    execl(self.c_str(), self.c_str(), "--session", input.c_str(), nullptr);
+    _exit(1);
+  }
+  close(out[1]);
+  const auto elapsed = await_first_byte(out[0], start);
+  waitpid(child, nullptr, 0);
+  return elapsed;
+}
+
+// A warm start: a judge process passes its descriptors to a running server.
+auto warm_start(const std::string &socket_path) -> double {
+  std::array<int, 2> out{};
+  if (pipe(out.data()) != 0) std::exit(1);
+  const auto start = Clock::now();
+  const auto child = fork();
+  if (child == 0) {
+    close(out[0]);
+    const auto in = open("/dev/null", O_RDONLY);
+    auto code = server::run_session(socket_path, {in, out[1], STDERR_FILENO});
+    // Only the first session can find the server still starting up.
+    while (!code.has_value()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      code = server::run_session(socket_path, {in, out[1], STDERR_FILENO});
+    }
+    _exit(*code);
+  }
+  close(out[1]);
+  const auto elapsed = await_first_byte(out[0], start);
+  waitpid(child, nullptr, 0);
+  return elapsed;
+}
+
+auto print(std::string_view mode, std::vector<double> latencies) -> void {
+  std::ranges::sort(latencies);
+  double total = 0;
+  for (auto latency : latencies) total += latency;
+  std::printf("%-10.*s %10zu %12.1f %12.1f %12.1f\n", static_cast<int>(mode.size()), mode.data(),
+              latencies.size(), total / static_cast<double>(latencies.size()),
+              latencies[latencies.size() / 2], latencies.back());
+}
+}  // namespace
+
+// Time from starting an interactor session to the contestant receiving its first byte, for an
+// interactor that parses `<numbers>` integers of input first.
+auto main(int argc, char **argv) -> int {
+  if (argc == 3 && std::string_view(argv[1]) == "--session") greet(parse_input(argv[2]));
+
+  const std::size_t numbers = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  const std::size_t sessions = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20;
+  if (numbers == 0 || sessions == 0) {
+    std::fputs("usage: warm_start [<numbers> [<sessions>]]\n", stderr);
+    return EXIT_FAILURE;
+  }
+
+  const auto self = std::string("/proc/") + std::to_string(getpid()) + "/exe";
+  const auto input = "/tmp/cplib-warm-start-" + std::to_string(getpid()) + ".in";
+  const auto socket_path = "/tmp/cplib-warm-start-" + std::to_string(getpid()) + ".sock";
+  {
+    std::ofstream file(input);
+    std::mt19937 random(1);
+    for (std::size_t i = 0; i < numbers; ++i) file << random() % 1000000000 << '\n';
+  }
+
+  const auto server_pid = fork();
+  if (server_pid == 0) {
+    std::int64_t sum = 0;
+    const server::Options options{
+        .socket_path = socket_path,
+        .warmup = [&] { sum = parse_input(input.c_str()); },
+    };
+    if (!server::serve(options, {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO})) {
+      _exit(1);
+    }
+    greet(sum);
+  }
+  // The first session waits for the server to finish its warmup and is not counted.
+  warm_start(socket_path);
+
+  std::vector<double> cold;
+  std::vector<double> warm;
+  for (std::size_t i = 0; i < sessions; ++i) {
+    cold.push_back(cold_start(self, input));
+    warm.push_back(warm_start(socket_path));
+  }
+
+  std::printf("%-10s %10s %12s %12s %12s\n", "start", "sessions", "mean(us)", "p50(us)",
+              "max(us)");
+  print("cold", cold);
+  print("warm", warm);
+
+  kill(server_pid, SIGTERM);
+  waitpid(server_pid, nullptr, 0);
+  unlink(socket_path.c_str());
+  unlink(input.c_str());
+}
@@ -16,25 +16,73 @@
 #ifndef CPLIB_INITIALIZERS_ARBITER_CHECKER_HPP_
 #define CPLIB_INITIALIZERS_ARBITER_CHECKER_HPP_
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <cctype>
+#include <cerrno>
 #include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
 #include <format>
-#include <fstream>
 #include <ios>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 
+#if __has_include("../common/checker.hpp")
+#include "../common/checker.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_
+// Stand-in for common/checker.hpp when this header is used on its own: the whole output is read,
+// with no output limit, early exit or profile.
+namespace cplib_initializers::common::checker {
+template <class Status>
+constexpr auto counts_as_accepted(Status status, double score) -> bool {
+  return status == Status::ACCEPTED || score == 1.0;
+}
+
+inline auto early_exit() -> bool { return false; }
+
+inline auto quit_unless_accepted(const cplib::evaluate::Result &result)
+    -> const cplib::evaluate::Result & {
+  return result;
+}
+
+struct Options {};
+
+struct Initializer : cplib::checker::Initializer {
+  Initializer() = default;
+
+  explicit Initializer(Options) {}
+
+ protected:
+  auto enable_early_exit(bool) -> void {}
+
+  auto set_reporter(std::unique_ptr<cplib::checker::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
+  }
+};
+}  // namespace cplib_initializers::common::checker
+#endif
+
 namespace cplib_initializers::arbiter::checker {
 
 constexpr std::string_view REPORT_PATH = "/tmp/_eval.score";
 
+/// Environment variable that overrides `REPORT_PATH`. A `--report-path` argument overrides both.
+constexpr std::string_view ENV_REPORT_PATH = "CPLIB_INITIALIZERS_ARBITER_REPORT";
+
 namespace detail {
 inline auto escape(std::string_view s) -> std::string {
   std::stringbuf buf(std::ios_base::out);
@@ -47,17 +95,70 @@ inline auto escape(std::string_view s) -> std::string {
   }
   return buf.str();
 }
+
+inline auto write_all(int fd, std::string_view content) -> bool {
+  while (!content.empty()) {
+    const auto written = write(fd, content.data(), content.size());
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) return false;
+    content.remove_prefix(static_cast<std::size_t>(written));
+  }
+  return true;
+}
+
+// Overwrite `path` with `content` in place, as Arbiter expects for `REPORT_PATH`. The report lives
+// in the sticky `/tmp`, where a file left behind by another user can be truncated but not replaced.
+inline auto write_in_place(const std::string &path, std::string_view content) -> bool {
+  const auto fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (fd < 0) return false;
+  const auto ok = write_all(fd, content);
+  return close(fd) == 0 && ok;
+}
+
+/**
+ * Replace `path` with `content` through a temporary file in the same directory, so that the
+ * report is never seen half-written and concurrent checkers with distinct paths do not collide.
+ */
+inline auto write_atomically(const std::string &path, std::string_view content) -> bool {
+  auto temp_path = path + ".XXXXXX";
+  const auto fd = mkostemp(temp_path.data(), O_CLOEXEC);
+  if (fd < 0) return false;
+  // `mkostemp` creates the file private to the user; give it the mode `open` would.
+  const auto mask = umask(0);
+  umask(mask);
+  auto ok = fchmod(fd, 0666 & ~mask) == 0 && write_all(fd, content);
+  ok = close(fd) == 0 && ok && std::rename(temp_path.c_str(), path.c_str()) == 0;
+  if (!ok) unlink(temp_path.c_str());
+  return ok;
+}
+
+inline auto configured_report_path() -> std::optional<std::string> {
+  const auto *env = std::getenv(ENV_REPORT_PATH.data());
+  if (env == nullptr || *env == '\0') return std::nullopt;
+  return env;
+}
 }  // namespace detail
 
 struct Reporter : cplib::checker::Reporter {
   using Report = cplib::checker::Report;
   using Status = Report::Status;
 
-  auto report(const Report &report) -> int override {
-    std::ofstream stream(std::string(REPORT_PATH), std::ios_base::binary);
+  // Report to `REPORT_PATH`, overwritten in place.
+  Reporter() : path(REPORT_PATH), atomic(false) {}
 
-    stream << report.status.to_string() << ": " << detail::escape(report.message) << '\n';
-    stream << std::llround(report.score * 10.0) << '\n';
+  // Report to a configured `path`, replaced atomically.
+  explicit Reporter(std::string path) : path(std::move(path)), atomic(true) {}
+
+  auto report(const Report &report) -> int override {
+    const auto content = std::format("{}: {}\n{}\n", report.status.to_string(),
+                                     detail::escape(report.message),
+                                     std::llround(report.score * 10.0));
+    const auto written =
+        atomic ? detail::write_atomically(path, content) : detail::write_in_place(path, content);
+    if (!written) {
+      std::cerr << "Failed to write the report to " << path << '\n';
+      return 1;
+    }
 
     if (report.status == Status::INTERNAL_ERROR) {
       return 1;
@@ -65,10 +166,15 @@ struct Reporter : cplib::checker::Reporter {
 
     return 0;
   }
+
+ private:
+  std::string path;
+  bool atomic;
 };
 
 namespace detail {
-constexpr std::string_view ARGS_USAGE = "<input_file> <output_file> <answer_file> [...]";
+constexpr std::string_view ARGS_USAGE =
+    "<input_file> <output_file> <answer_file> [--report-path=<path>] [...]";
 
 inline auto print_help_message(std::string_view program_name) -> void {
   std::string msg = std::format(CPLIB_STARTUP_TEXT
@@ -84,14 +190,22 @@ inline auto print_help_message(std::string_view program_name) -> void {
 }
 }  // namespace detail
 
-struct Initializer : cplib::checker::Initializer {
-  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
+struct Initializer : common::checker::Initializer {
+  using common::checker::Initializer::Initializer;
 
-    state.reporter = std::make_unique<Reporter>();
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
+    if (auto path = detail::configured_report_path()) {
+      set_reporter(std::make_unique<Reporter>(*path));
+    } else {
+      set_reporter(std::make_unique<Reporter>());
+    }
 
     auto parsed_args = cplib::cmd_args::ParsedArgs(args);
 
+    if (auto it = parsed_args.vars.find("report-path"); it != parsed_args.vars.end()) {
+      set_reporter(std::make_unique<Reporter>(it->second));
+    }
+
     if (parsed_args.has_flag("help")) {
       detail::print_help_message(arg0);
     }
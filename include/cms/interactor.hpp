@@ -16,19 +16,116 @@
 #ifndef CPLIB_INITIALIZERS_CMS_INTERACTOR_HPP_
 #define CPLIB_INITIALIZERS_CMS_INTERACTOR_HPP_
 
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <chrono>
 #include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <format>
+#include <fstream>
+#include <initializer_list>
 #include <iomanip>
 #include <ios>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 
+#if __has_include("../common/interactor.hpp")
+#include "../common/interactor.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_
+// Stand-in for common/interactor.hpp when this header is used on its own: the contestant is
+// connected through cplib's own streams, with no contestant channel or profile.
+namespace cplib_initializers::common {
+namespace channel {
+struct Options {};
+}  // namespace channel
+
+namespace interactor {
+struct Initializer : cplib::interactor::Initializer {
+  Initializer() = default;
+
+  explicit Initializer(channel::Options) {}
+
+ protected:
+  auto allow_sessions() -> void {}
+
+  [[nodiscard]] auto uses_channel() const -> bool { return false; }
+
+  auto set_reporter(std::unique_ptr<cplib::interactor::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
+  }
+
+  auto set_user_fileno(int from_user_fd, int to_user_fd, cplib::trace::Level trace_level)
+      -> void {
+    set_from_user_fileno(from_user_fd, trace_level);
+    set_to_user_fileno(to_user_fd);
+  }
+};
+}  // namespace interactor
+}  // namespace cplib_initializers::common
+#endif
+
+#if __has_include("../common/resource_usage.hpp")
+#include "../common/resource_usage.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_
+// Stand-in for common/resource_usage.hpp when this header is used on its own: no usage line.
+namespace cplib_initializers::common::resource_usage {
+inline auto line() -> std::optional<std::string> { return std::nullopt; }
+}  // namespace cplib_initializers::common::resource_usage
+#endif
+
+#if __has_include("../common/root.hpp")
+#include "../common/root.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_ROOT_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_ROOT_HPP_
+// Stand-in for common/root.hpp when this header is used on its own: files are resolved against
+// the working directory.
+namespace cplib_initializers::common::root {
+class Root {
+ public:
+  Root() = default;
+
+  explicit Root(const cplib::cmd_args::ParsedArgs &parsed_args) {
+    if (parsed_args.vars.contains("root") || parsed_args.vars.contains("root-fd")) {
+      cplib::panic("--root and --root-fd need common/root.hpp next to this header");
+    }
+  }
+
+  [[nodiscard]] auto open(std::string_view name, int flags = O_RDONLY) const -> int {
+    const auto fd = ::open(std::string(name).c_str(), flags | O_CLOEXEC);
+    if (fd < 0) cplib::panic(std::format("Failed to open {}: {}", name, std::strerror(errno)));
+    return fd;
+  }
+
+  [[nodiscard]] auto try_write(std::string_view name, std::string_view content) const -> bool {
+    std::ofstream stream(std::string(name), std::ios_base::binary);
+    stream << content;
+    stream.flush();
+    return static_cast<bool>(stream);
+  }
+
+  auto write(std::string_view name, std::string_view content) const -> void {
+    if (!try_write(name, content)) cplib::panic(std::format("Failed to write {}", name));
+  }
+};
+}  // namespace cplib_initializers::common::root
+#endif
+
 namespace cplib_initializers::cms::interactor {
 
 constexpr std::string_view FILENAME_INF = "input.txt";
@@ -38,6 +135,13 @@ struct Reporter : cplib::interactor::Reporter {
   using Status = Report::Status;
 
   auto report(const Report &report) -> int override {
+    const auto exit_code = report_verdict(report);
+    if (const auto usage = common::resource_usage::line()) std::cerr << *usage << '\n';
+    return exit_code;
+  }
+
+ private:
+  auto report_verdict(const Report &report) -> int {
     std::ostream score_stream(std::cout.rdbuf());
     std::ostream status_stream(std::cerr.rdbuf());
 
@@ -66,7 +170,9 @@ struct Reporter : cplib::interactor::Reporter {
 };
 
 namespace detail {
-constexpr std::string_view ARGS_USAGE = "<from_user_file> <to_user_file> [...]";
+constexpr std::string_view ARGS_USAGE =
+    "<from_user_file_0> <to_user_file_0> [<from_user_file_1> <to_user_file_1> ...] "
+    "[--root=<dir> | --root-fd=<fd>]";
 
 inline auto print_help_message(std::string_view program_name) -> void {
   std::string msg = std::format(CPLIB_STARTUP_TEXT
@@ -82,11 +188,210 @@ inline auto print_help_message(std::string_view program_name) -> void {
 }
 }  // namespace detail
 
-struct Initializer : cplib::interactor::Initializer {
-  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
+#if __has_include("../common/interactor.hpp")
+/**
+ * Contestant processes of a communication task, available when the manager talks to several
+ * processes or installs the contestant channel (see common/interactor.hpp).
+ *
+ * With `communication_num_processes` greater than one, CMS passes the manager a FIFO pair per
+ * process. Process 0 is also installed as the state's `from_user` and `to_user`, so interactors
+ * for single-process tasks need no changes.
+ */
+class Processes {
+ public:
+  Processes() = default;
+  Processes(const Processes &) = delete;
+  auto operator=(const Processes &) -> Processes & = delete;
+
+  Processes(Processes &&other) noexcept
+      : state_(other.state_),
+        idle_timeout_(other.idle_timeout_),
+        epoll_fd_(std::exchange(other.epoll_fd_, -1)),
+        processes_(std::move(other.processes_)),
+        channels_(std::move(other.channels_)),
+        active_(std::exchange(other.active_, 0)),
+        next_(other.next_) {}
+
+  auto operator=(Processes &&other) noexcept -> Processes & {
+    std::swap(state_, other.state_);
+    std::swap(idle_timeout_, other.idle_timeout_);
+    std::swap(epoll_fd_, other.epoll_fd_);
+    std::swap(processes_, other.processes_);
+    std::swap(channels_, other.channels_);
+    std::swap(active_, other.active_);
+    std::swap(next_, other.next_);
+    return *this;
+  }
+
+  ~Processes() {
+    if (epoll_fd_ >= 0) close(epoll_fd_);
+  }
+
+  [[nodiscard]] auto size() const -> std::size_t { return processes_.size(); }
+
+  [[nodiscard]] auto from_user(std::size_t index) -> cplib::var::Reader & {
+    return *processes_.at(index).from_user;
+  }
+
+  [[nodiscard]] auto to_user(std::size_t index) -> std::ostream & {
+    return *processes_.at(index).to_user;
+  }
+
+  /**
+   * Send all pending `to_user` output and wait until an active process has input or has closed
+   * its channel. Returns the index of that process; when several are ready they are served in
+   * turn, so a slow process never holds up the others.
+   */
+  auto wait_any() -> std::size_t {
+    if (active_ == 0) cplib::panic("cms::interactor::Processes::wait_any: no active process");
+
+    while (true) {
+      if (auto index = next_buffered(); index < size()) return serve(index);
+
+      for (std::size_t i = 0; i < size(); ++i) {
+        auto &process = processes_[i];
+        if (!process.active) continue;
+        process.to_user_buf->flush();
+        watch_to_user(i, process.to_user_buf->queued() > 0);
+      }
+
+      std::array<epoll_event, 16> events{};
+      const int timeout = idle_timeout_.count() > 0 ? static_cast<int>(idle_timeout_.count()) : -1;
+      int ready;
+      do {
+        ready = epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), timeout);
+      } while (ready < 0 && errno == EINTR);
+      if (ready < 0) {
+        cplib::panic(std::format("cms::interactor::Processes::wait_any: epoll_wait failed: {}",
+                                 std::strerror(errno)));
+      }
+      if (ready == 0) {
+        if (all_idle()) state_->quit_wa(common::channel::detail::idle_message(idle_timeout_));
+        continue;
+      }
+
+      std::size_t chosen = size();
+      for (int i = 0; i < ready; ++i) {
+        const auto index = static_cast<std::size_t>(events[i].data.u64 >> 1);
+        if ((events[i].data.u64 & 1) != 0) {
+          processes_[index].to_user_buf->drain();
+        } else if (processes_[index].active && is_before(index, chosen)) {
+          chosen = index;
+        }
+      }
+      if (chosen < size()) return serve(chosen);
+    }
+  }
+
+  // Stop waiting on a process, e.g. once it has sent its last message.
+  auto deactivate(std::size_t index) -> void {
+    auto &process = processes_.at(index);
+    if (!process.active) return;
+    process.active = false;
+    --active_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, process.from_user_buf->fd(), nullptr);
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, process.to_user_buf->fd(), nullptr);
+  }
+
+ private:
+  friend struct Initializer;
+
+  struct Process {
+    cplib::var::Reader *from_user;
+    std::ostream *to_user;
+    common::channel::FromUserBuf *from_user_buf;
+    common::channel::ToUserBuf *to_user_buf;
+    bool active = true;
+    bool watching_to_user = false;
+  };
+
+  auto init(cplib::interactor::State &state, std::chrono::milliseconds idle_timeout) -> void {
+    state_ = &state;
+    idle_timeout_ = idle_timeout;
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+      cplib::panic(std::format("Failed to create epoll instance: {}", std::strerror(errno)));
+    }
+  }
+
+  auto add(Process process) -> void {
+    const auto index = static_cast<std::uint64_t>(size());
+    epoll_event read_event{.events = EPOLLIN, .data = {.u64 = index << 1}};
+    epoll_event write_event{.events = 0, .data = {.u64 = (index << 1) | 1}};
+    if (process.from_user_buf->fd() >= 0 &&
+        (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, process.from_user_buf->fd(), &read_event) != 0 ||
+         epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, process.to_user_buf->fd(), &write_event) != 0)) {
+      cplib::panic(std::format("Failed to watch process {}: {}", index, std::strerror(errno)));
+    }
+    processes_.push_back(process);
+    ++active_;
+  }
+
+  auto watch_to_user(std::size_t index, bool watch) -> void {
+    auto &process = processes_[index];
+    if (process.watching_to_user == watch) return;
+    epoll_event event{.events = watch ? static_cast<std::uint32_t>(EPOLLOUT) : 0,
+                      .data = {.u64 = (static_cast<std::uint64_t>(index) << 1) | 1}};
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, process.to_user_buf->fd(), &event);
+    process.watching_to_user = watch;
+  }
+
+  // First active process in serving order whose input is already buffered, or `size()`.
+  [[nodiscard]] auto next_buffered() -> std::size_t {
+    for (std::size_t k = 0; k < size(); ++k) {
+      const auto index = (next_ + k) % size();
+      const auto &process = processes_[index];
+      // Replayed processes have no descriptor and never block.
+      if (process.active &&
+          (process.from_user_buf->fd() < 0 || process.from_user_buf->in_avail() > 0)) {
+        return index;
+      }
+    }
+    return size();
+  }
+
+  // Whether `index` comes before `other` in serving order, which starts at `next_`.
+  [[nodiscard]] auto is_before(std::size_t index, std::size_t other) const -> bool {
+    if (other >= size()) return true;
+    return (index + size() - next_) % size() < (other + size() - next_) % size();
+  }
+
+  auto serve(std::size_t index) -> std::size_t {
+    next_ = (index + 1) % size();
+    return index;
+  }
+
+  // No process sent anything and every one has read all its input.
+  [[nodiscard]] auto all_idle() const -> bool {
+    for (const auto &process : processes_) {
+      if (!process.active) continue;
+      if (process.to_user_buf->queued() > 0 ||
+          common::channel::detail::unread(process.to_user_buf->fd()) > 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  cplib::interactor::State *state_{};
+  std::chrono::milliseconds idle_timeout_{0};
+  int epoll_fd_ = -1;
+  std::vector<Process> processes_;
+  std::vector<std::unique_ptr<common::channel::Channel>> channels_;
+  std::size_t active_ = 0;
+  std::size_t next_ = 0;
+};
+#endif
+
+struct Initializer : common::interactor::Initializer {
+#if __has_include("../common/interactor.hpp")
+  Processes processes;
+#endif
 
-    state.reporter = std::make_unique<Reporter>();
+  using common::interactor::Initializer::Initializer;
+
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
+    set_reporter(std::make_unique<Reporter>());
 
     auto parsed_args = cplib::cmd_args::ParsedArgs(args);
 
@@ -94,26 +399,104 @@ struct Initializer : cplib::interactor::Initializer {
       detail::print_help_message(arg0);
     }
 
-    if (parsed_args.ordered.size() < 2) {
+    if (parsed_args.ordered.size() < 2 || parsed_args.ordered.size() % 2 != 0) {
       cplib::panic("Program must be run with the following arguments:\n  " +
                    std::string(detail::ARGS_USAGE));
     }
 
-    const auto &from_user_file = parsed_args.ordered[0];
-    const auto &to_user_file = parsed_args.ordered[1];
+    const common::root::Root root(parsed_args);
 
     // When the sandbox opens the other endpoints of these fifos to redirect
     // them to to stdin/out it does so first for stdin and then for stdout.
     // We must match that order as otherwise we would deadlock.
+    // Each process does so independently, so opening the pairs in order is safe.
 
     signal(SIGPIPE, SIG_IGN);
 
-    set_to_user_path(to_user_file);
-    set_from_user_path(from_user_file, cplib::trace::Level::NONE);
+    // Several processes are multiplexed by the channel, so it is installed for them regardless.
+    if (parsed_args.ordered.size() > 2 || uses_channel()) {
+      open_processes(parsed_args, root);
+    } else {
+      const int to_user_fd = root.open(parsed_args.ordered[1], O_WRONLY);
+      set_user_fileno(root.open(parsed_args.ordered[0]), to_user_fd, cplib::trace::Level::NONE);
+    }
 
-    set_inf_path(FILENAME_INF, cplib::trace::Level::NONE);
+    set_inf_fileno(root.open(FILENAME_INF), cplib::trace::Level::NONE);
   }
+
+ private:
+#if __has_include("../common/interactor.hpp")
+  // Open the channel of each process, in the order the sandbox opens the other ends.
+  auto open_processes(const cplib::cmd_args::ParsedArgs &parsed_args,
+                      const common::root::Root &root) -> void {
+    auto &state = this->state();
+
+    const auto options =
+        common::channel::resolve_options(channel_options.value_or(common::channel::Options{}));
+    // The manager passes each session its fifos by path, which a server cannot take over.
+    if (!options.server.socket_path.empty()) {
+      cplib::panic("server: the cms interactor cannot run as a server");
+    }
+    processes.init(state, options.idle_timeout);
+
+    // A replay has no contestant to open the other ends of the fifos. Transcripts of separate
+    // processes do not record how their messages interleave, so only one process can be replayed.
+    const bool replaying = !options.replay_path.empty();
+    if (replaying && parsed_args.ordered.size() > 2) {
+      cplib::panic("replay: only single-process transcripts can be replayed");
+    }
+
+    for (std::size_t i = 0; i < parsed_args.ordered.size() / 2; ++i) {
+      const int to_user_fd = replaying ? -1 : root.open(parsed_args.ordered[i * 2 + 1], O_WRONLY);
+      const int from_user_fd = replaying ? -1 : root.open(parsed_args.ordered[i * 2]);
+
+      if (i == 0) {
+        common::placement::apply(options.placement, from_user_fd);
+        to_user_buf = std::make_unique<common::channel::ToUserBuf>(to_user_fd, options);
+        auto from_user_buf = std::make_unique<common::channel::FromUserBuf>(
+            from_user_fd, to_user_buf.get(), options);
+        processes.add({&state.from_user, &state.to_user, from_user_buf.get(), to_user_buf.get()});
+        common::channel::install(state, std::move(from_user_buf), to_user_buf.get(),
+                                 cplib::trace::Level::NONE);
+        continue;
+      }
+
+      auto process_options = options;
+      for (auto *path : {&process_options.trace_path, &process_options.record_path}) {
+        if (!path->empty()) *path += std::format(".{}", i);
+      }
+      auto &channel = processes.channels_.emplace_back(std::make_unique<common::channel::Channel>(
+          state, from_user_fd, to_user_fd, std::to_string(i), cplib::trace::Level::NONE,
+          process_options));
+      processes.add({&channel->from_user(), &channel->to_user(), channel->from_user_buf(),
+                     channel->to_user_buf()});
+    }
+
+    // A process may be waiting for output queued for another one before it can answer.
+    for (auto &reader : processes.processes_) {
+      for (const auto &writer : processes.processes_) {
+        if (&reader != &writer) reader.from_user_buf->flush_before_read(writer.to_user_buf);
+      }
+    }
+  }
+#else
+  // Without common/interactor.hpp there is no contestant channel to multiplex processes with.
+  auto open_processes(const cplib::cmd_args::ParsedArgs &, const common::root::Root &) -> void {
+    cplib::panic("cms::interactor: several processes need common/interactor.hpp next to it");
+  }
+#endif
 };
+
+#if __has_include("../common/interactor.hpp")
+// The contestant processes of the interactor `state`, which must use the CMS initializer.
+inline auto processes(cplib::interactor::State &state) -> Processes & {
+  auto &processes = dynamic_cast<Initializer &>(*state.initializer).processes;
+  if (processes.size() == 0) {
+    cplib::panic("cms::interactor::processes: the contestant channel is not installed");
+  }
+  return processes;
+}
+#endif
 }  // namespace cplib_initializers::cms::interactor
 
 #endif
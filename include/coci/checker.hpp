@@ -26,10 +26,47 @@
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 
+#if __has_include("../common/checker.hpp")
+#include "../common/checker.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_
+// Stand-in for common/checker.hpp when this header is used on its own: the whole output is read,
+// with no output limit, early exit or profile.
+namespace cplib_initializers::common::checker {
+template <class Status>
+constexpr auto counts_as_accepted(Status status, double score) -> bool {
+  return status == Status::ACCEPTED || score == 1.0;
+}
+
+inline auto early_exit() -> bool { return false; }
+
+inline auto quit_unless_accepted(const cplib::evaluate::Result &result)
+    -> const cplib::evaluate::Result & {
+  return result;
+}
+
+struct Options {};
+
+struct Initializer : cplib::checker::Initializer {
+  Initializer() = default;
+
+  explicit Initializer(Options) {}
+
+ protected:
+  auto enable_early_exit(bool) -> void {}
+
+  auto set_reporter(std::unique_ptr<cplib::checker::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
+  }
+};
+}  // namespace cplib_initializers::common::checker
+#endif
+
 namespace cplib_initializers::coci::checker {
 
 enum struct ExitCode : std::uint8_t {
@@ -108,11 +145,11 @@ inline auto print_help_message(std::string_view program_name) -> void {
 }
 }  // namespace detail
 
-struct Initializer : cplib::checker::Initializer {
-  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
+struct Initializer : common::checker::Initializer {
+  using common::checker::Initializer::Initializer;
 
-    state.reporter = std::make_unique<Reporter>();
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
+    set_reporter(std::make_unique<Reporter>());
 
     auto parsed_args = cplib::cmd_args::ParsedArgs(args);
 
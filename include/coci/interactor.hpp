@@ -25,10 +25,47 @@
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 
+#if __has_include("../common/interactor.hpp")
+#include "../common/interactor.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_
+// Stand-in for common/interactor.hpp when this header is used on its own: the contestant is
+// connected through cplib's own streams, with no contestant channel or profile.
+namespace cplib_initializers::common {
+namespace channel {
+struct Options {};
+}  // namespace channel
+
+namespace interactor {
+struct Initializer : cplib::interactor::Initializer {
+  Initializer() = default;
+
+  explicit Initializer(channel::Options) {}
+
+ protected:
+  auto allow_sessions() -> void {}
+
+  [[nodiscard]] auto uses_channel() const -> bool { return false; }
+
+  auto set_reporter(std::unique_ptr<cplib::interactor::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
+  }
+
+  auto set_user_fileno(int from_user_fd, int to_user_fd, cplib::trace::Level trace_level)
+      -> void {
+    set_from_user_fileno(from_user_fd, trace_level);
+    set_to_user_fileno(to_user_fd);
+  }
+};
+}  // namespace interactor
+}  // namespace cplib_initializers::common
+#endif
+
 namespace cplib_initializers::coci::interactor {
 
 enum struct ExitCode : std::uint8_t {
@@ -82,11 +119,11 @@ inline auto print_help_message(std::string_view program_name) -> void {
 }
 }  // namespace detail
 
-struct Initializer : cplib::interactor::Initializer {
-  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
+struct Initializer : common::interactor::Initializer {
+  using common::interactor::Initializer::Initializer;
 
-    state.reporter = std::make_unique<Reporter>();
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
+    set_reporter(std::make_unique<Reporter>());
 
     auto parsed_args = cplib::cmd_args::ParsedArgs(args);
 
@@ -102,8 +139,9 @@ struct Initializer : cplib::interactor::Initializer {
     signal(SIGPIPE, SIG_IGN);
 
     set_inf_path(parsed_args.ordered[0], cplib::trace::Level::NONE);
-    set_from_user_fileno(fileno(stdin), cplib::trace::Level::NONE);
-    set_to_user_fileno(fileno(stdout));
+    // Verdicts go to the session's stderr.
+    allow_sessions();
+    set_user_fileno(fileno(stdin), fileno(stdout), cplib::trace::Level::NONE);
   }
 };
 }  // namespace cplib_initializers::coci::interactor
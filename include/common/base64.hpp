@@ -0,0 +1,404 @@
+/*
+ * This file is part of CPLibInitializers.
+ *
+ * CPLibInitializers is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * CPLibInitializers is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with
+ * CPLibInitializers. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file base64.hpp
+ *
+ * Base64 (RFC 4648, standard alphabet) used by the two-step interaction.
+ *
+ * Encoding always pads. Decoding accepts padded and unpadded input: up to two trailing `=`, every
+ * other character from the alphabet, and no group of a single character. Both directions write
+ * into a buffer of the exact size and make a single pass over the input, using SSE4.1 or AVX2
+ * where the CPU supports them.
+ */
+
+#ifndef CPLIB_INITIALIZERS_COMMON_BASE64_HPP_
+#define CPLIB_INITIALIZERS_COMMON_BASE64_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define CPLIB_INITIALIZERS_BASE64_X86 1
+#endif
+
+namespace cplib_initializers::common::base64 {
+
+/// Implementation used for a call. `BEST` is the fastest one the CPU supports.
+enum struct Kernel : std::uint8_t {
+  BEST,
+  SCALAR,
+  SSE41,
+  AVX2,
+};
+
+namespace detail {
+constexpr std::string_view ALPHABET =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+constexpr std::uint8_t INVALID = 0xff;
+
+constexpr auto make_decode_table() -> std::array<std::uint8_t, 256> {
+  std::array<std::uint8_t, 256> table{};
+  table.fill(INVALID);
+  for (std::size_t i = 0; i < ALPHABET.size(); ++i) {
+    table[static_cast<unsigned char>(ALPHABET[i])] = static_cast<std::uint8_t>(i);
+  }
+  return table;
+}
+
+constexpr auto DECODE_TABLE = make_decode_table();
+
+// Encode whole triplets from `in`, leaving the tail to the caller. Returns the bytes consumed.
+inline auto encode_scalar(const unsigned char *in, std::size_t size, char *out) -> std::size_t {
+  std::size_t i = 0;
+  for (; i + 3 <= size; i += 3, out += 4) {
+    const std::uint32_t bits = (static_cast<std::uint32_t>(in[i]) << 16) |
+                               (static_cast<std::uint32_t>(in[i + 1]) << 8) | in[i + 2];
+    out[0] = ALPHABET[(bits >> 18) & 0x3f];
+    out[1] = ALPHABET[(bits >> 12) & 0x3f];
+    out[2] = ALPHABET[(bits >> 6) & 0x3f];
+    out[3] = ALPHABET[bits & 0x3f];
+  }
+  return i;
+}
+
+// Decode whole quads from `in`, leaving the tail to the caller. Returns the characters consumed,
+// or nullopt on a character outside the alphabet.
+inline auto decode_scalar(const char *in, std::size_t size, unsigned char *out)
+    -> std::optional<std::size_t> {
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4, out += 3) {
+    const auto a = DECODE_TABLE[static_cast<unsigned char>(in[i])];
+    const auto b = DECODE_TABLE[static_cast<unsigned char>(in[i + 1])];
+    const auto c = DECODE_TABLE[static_cast<unsigned char>(in[i + 2])];
+    const auto d = DECODE_TABLE[static_cast<unsigned char>(in[i + 3])];
+    if ((a | b | c | d) == INVALID) return std::nullopt;
+    const std::uint32_t bits = (static_cast<std::uint32_t>(a) << 18) |
+                               (static_cast<std::uint32_t>(b) << 12) |
+                               (static_cast<std::uint32_t>(c) << 6) | d;
+    out[0] = static_cast<unsigned char>(bits >> 16);
+    out[1] = static_cast<unsigned char>(bits >> 8);
+    out[2] = static_cast<unsigned char>(bits);
+  }
+  return i;
+}
+
+#ifdef CPLIB_INITIALIZERS_BASE64_X86
+// The vector kernels follow W. Muła and D. Lemire, "Faster Base64 Encoding and Decoding Using AVX2
+// Instructions" (2018). Each 32-bit lane holds one triplet or quad; the 256-bit kernels run the
+// 128-bit algorithm on both halves.
+
+// Offset from an index to its character, selected by the index range (see `encode_translate`).
+alignas(16) constexpr std::array<std::int8_t, 16> ENCODE_OFFSETS{
+    'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+    '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A',      0,        0};
+// Bit `h` of `VALID_HIGH[l]` is set if the character 0xhl is in the alphabet.
+alignas(16) constexpr std::array<std::uint8_t, 16> VALID_HIGH{
+    0xa8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf0, 0x54, 0x50, 0x50, 0x50, 0x54};
+alignas(16) constexpr std::array<std::uint8_t, 16> HIGH_BIT{0x01, 0x02, 0x04, 0x08, 0x10, 0x20,
+                                                            0x40, 0x80, 0,    0,    0,    0,
+                                                            0,    0,    0,    0};
+// Offset from a character to its index by high nibble. '/' is special-cased.
+alignas(16) constexpr std::array<std::int8_t, 16> DECODE_OFFSETS{0,   0,   19,  4, -65, -65,
+                                                                 -71, -71, 0,   0, 0,   0,
+                                                                 0,   0,   0,   0};
+// Gathers the three bytes of each 32-bit lane, most significant first, into the low 12 bytes.
+alignas(16) constexpr std::array<std::int8_t, 16> DECODE_GATHER{2,  1,  0,  6,  5,  4,  10, 9,
+                                                                8,  14, 13, 12, -1, -1, -1, -1};
+
+template <class T>
+__attribute__((target("sse4.1"))) inline auto load(const std::array<T, 16> &table) -> __m128i {
+  return _mm_load_si128(reinterpret_cast<const __m128i *>(table.data()));
+}
+
+// Spread 12 bytes to 16 six-bit indices, one per byte.
+__attribute__((target("sse4.1"))) inline auto encode_unpack(__m128i in) -> __m128i {
+  in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  const auto hi = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)),
+                                  _mm_set1_epi32(0x04000040));
+  const auto lo = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)),
+                                  _mm_set1_epi32(0x01000010));
+  return _mm_or_si128(hi, lo);
+}
+
+// Map indices to the alphabet by adding a per-range offset chosen with a shuffle.
+__attribute__((target("sse4.1"))) inline auto encode_translate(__m128i indices) -> __m128i {
+  auto range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  const auto upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+  range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+  return _mm_add_epi8(_mm_shuffle_epi8(load(ENCODE_OFFSETS), range), indices);
+}
+
+__attribute__((target("sse4.1"))) inline auto encode_sse41(const unsigned char *in,
+                                                           std::size_t size, char *out)
+    -> std::size_t {
+  std::size_t i = 0;
+  // Loads 16 bytes and uses 12.
+  for (; i + 16 <= size; i += 12, out += 16) {
+    const auto in_block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), encode_translate(encode_unpack(in_block)));
+  }
+  return i + encode_scalar(in + i, size - i, out);
+}
+
+// Replace each valid character with its index. Returns false if any character is invalid.
+__attribute__((target("sse4.1"))) inline auto decode_translate(__m128i &in) -> bool {
+  const auto hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f));
+  const auto lo_nibbles = _mm_and_si128(in, _mm_set1_epi8(0x0f));
+  const auto matched = _mm_and_si128(_mm_shuffle_epi8(load(VALID_HIGH), lo_nibbles),
+                                     _mm_shuffle_epi8(load(HIGH_BIT), hi_nibbles));
+  if (_mm_movemask_epi8(_mm_cmpeq_epi8(matched, _mm_setzero_si128())) != 0) return false;
+  const auto offset = _mm_blendv_epi8(_mm_shuffle_epi8(load(DECODE_OFFSETS), hi_nibbles),
+                                      _mm_set1_epi8(16),
+                                      _mm_cmpeq_epi8(in, _mm_set1_epi8('/')));
+  in = _mm_add_epi8(in, offset);
+  return true;
+}
+
+// Pack 16 six-bit indices into 12 bytes at the bottom of the vector.
+__attribute__((target("sse4.1"))) inline auto decode_pack(__m128i indices) -> __m128i {
+  const auto pairs = _mm_maddubs_epi16(indices, _mm_set1_epi32(0x01400140));
+  const auto quads = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+  return _mm_shuffle_epi8(quads, load(DECODE_GATHER));
+}
+
+__attribute__((target("sse4.1"))) inline auto decode_sse41(const char *in, std::size_t size,
+                                                           unsigned char *out)
+    -> std::optional<std::size_t> {
+  std::size_t i = 0;
+  for (; i + 16 <= size; i += 16, out += 12) {
+    auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    if (!decode_translate(block)) return std::nullopt;
+    // Store only the 12 decoded bytes: the output buffer has no slack.
+    const auto packed = decode_pack(block);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out), packed);
+    const auto tail = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+    std::memcpy(out + 8, &tail, 4);
+  }
+  const auto rest = decode_scalar(in + i, size - i, out);
+  if (!rest) return std::nullopt;
+  return i + *rest;
+}
+
+__attribute__((target("avx2"))) inline auto encode_avx2(const unsigned char *in, std::size_t size,
+                                                        char *out) -> std::size_t {
+  const auto spread = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2,
+                                       1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+  const auto offsets = _mm256_broadcastsi128_si256(load(ENCODE_OFFSETS));
+  std::size_t i = 0;
+  // Loads 16 bytes at `i` and at `i + 12`, and uses 24.
+  for (; i + 28 <= size; i += 24, out += 32) {
+    auto block = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 12)), 1);
+    block = _mm256_shuffle_epi8(block, spread);
+    const auto hi = _mm256_mulhi_epu16(_mm256_and_si256(block, _mm256_set1_epi32(0x0fc0fc00)),
+                                       _mm256_set1_epi32(0x04000040));
+    const auto lo = _mm256_mullo_epi16(_mm256_and_si256(block, _mm256_set1_epi32(0x003f03f0)),
+                                       _mm256_set1_epi32(0x01000010));
+    const auto indices = _mm256_or_si256(hi, lo);
+    auto range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    const auto upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    range = _mm256_or_si256(range, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+    const auto chars = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), chars);
+  }
+  return i + encode_sse41(in + i, size - i, out);
+}
+
+__attribute__((target("avx2"))) inline auto decode_avx2(const char *in, std::size_t size,
+                                                       unsigned char *out)
+    -> std::optional<std::size_t> {
+  const auto valid_high = _mm256_broadcastsi128_si256(load(VALID_HIGH));
+  const auto high_bit = _mm256_broadcastsi128_si256(load(HIGH_BIT));
+  const auto offsets = _mm256_broadcastsi128_si256(load(DECODE_OFFSETS));
+  const auto gather = _mm256_broadcastsi128_si256(load(DECODE_GATHER));
+  std::size_t i = 0;
+  for (; i + 32 <= size; i += 32, out += 24) {
+    auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    const auto hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(block, 4), _mm256_set1_epi8(0x0f));
+    const auto lo_nibbles = _mm256_and_si256(block, _mm256_set1_epi8(0x0f));
+    const auto matched = _mm256_and_si256(_mm256_shuffle_epi8(valid_high, lo_nibbles),
+                                          _mm256_shuffle_epi8(high_bit, hi_nibbles));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(matched, _mm256_setzero_si256())) != 0) {
+      return std::nullopt;
+    }
+    const auto offset =
+        _mm256_blendv_epi8(_mm256_shuffle_epi8(offsets, hi_nibbles), _mm256_set1_epi8(16),
+                           _mm256_cmpeq_epi8(block, _mm256_set1_epi8('/')));
+    block = _mm256_add_epi8(block, offset);
+    const auto pairs = _mm256_maddubs_epi16(block, _mm256_set1_epi32(0x01400140));
+    const auto quads = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+    // 12 bytes at the bottom of each half, then the halves joined into the low 24 bytes.
+    const auto packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(quads, gather),
+                                                    _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm256_castsi256_si128(packed));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out + 16), _mm256_extracti128_si256(packed, 1));
+  }
+  const auto rest = decode_sse41(in + i, size - i, out);
+  if (!rest) return std::nullopt;
+  return i + *rest;
+}
+#endif
+
+inline auto resolve(Kernel kernel) -> Kernel {
+  if (kernel != Kernel::BEST) return kernel;
+#ifdef CPLIB_INITIALIZERS_BASE64_X86
+  static const Kernel best = __builtin_cpu_supports("avx2")     ? Kernel::AVX2
+                             : __builtin_cpu_supports("sse4.1") ? Kernel::SSE41
+                                                                : Kernel::SCALAR;
+  return best;
+#else
+  return Kernel::SCALAR;
+#endif
+}
+}  // namespace detail
+
+/// Whether `kernel` can run on this CPU.
+inline auto supported(Kernel kernel) -> bool {
+  switch (kernel) {
+    case Kernel::BEST:
+    case Kernel::SCALAR:
+      return true;
+#ifdef CPLIB_INITIALIZERS_BASE64_X86
+    case Kernel::SSE41:
+      return __builtin_cpu_supports("sse4.1");
+    case Kernel::AVX2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+constexpr auto encoded_size(std::size_t size) -> std::size_t { return (size + 2) / 3 * 4; }
+
+/**
+ * Encode `size` bytes from `in` into `out`, which must hold `encoded_size(size)` characters.
+ * `kernel` must be supported.
+ */
+inline auto encode(const void *in, std::size_t size, char *out, Kernel kernel = Kernel::BEST)
+    -> void {
+  const auto *bytes = static_cast<const unsigned char *>(in);
+  std::size_t done = 0;
+  switch (detail::resolve(kernel)) {
+#ifdef CPLIB_INITIALIZERS_BASE64_X86
+    case Kernel::AVX2:
+      done = detail::encode_avx2(bytes, size, out);
+      break;
+    case Kernel::SSE41:
+      done = detail::encode_sse41(bytes, size, out);
+      break;
+#endif
+    default:
+      done = detail::encode_scalar(bytes, size, out);
+      break;
+  }
+  out += done / 3 * 4;
+  if (const auto rest = size - done; rest > 0) {
+    const std::uint32_t bits = (static_cast<std::uint32_t>(bytes[done]) << 16) |
+                               (rest == 2 ? static_cast<std::uint32_t>(bytes[done + 1]) << 8 : 0);
+    out[0] = detail::ALPHABET[(bits >> 18) & 0x3f];
+    out[1] = detail::ALPHABET[(bits >> 12) & 0x3f];
+    out[2] = rest == 2 ? detail::ALPHABET[(bits >> 6) & 0x3f] : '=';
+    out[3] = '=';
+  }
+}
+
+inline auto encode(std::string_view data, Kernel kernel = Kernel::BEST) -> std::string {
+  std::string out(encoded_size(data.size()), '\0');
+  encode(data.data(), data.size(), out.data(), kernel);
+  return out;
+}
+
+namespace detail {
+// Number of characters before the padding, or nullopt if the length or padding is malformed.
+constexpr auto unpadded_size(std::string_view encoded) -> std::optional<std::size_t> {
+  auto size = encoded.size();
+  if (size % 4 == 1) return std::nullopt;
+  for (int i = 0; i < 2 && size > 0 && encoded[size - 1] == '='; ++i) --size;
+  if (size % 4 == 1) return std::nullopt;
+  return size;
+}
+}  // namespace detail
+
+/**
+ * Number of bytes `encoded` decodes to, or nullopt if its length or padding is malformed. The
+ * characters before the padding are not checked.
+ */
+constexpr auto decoded_size(std::string_view encoded) -> std::optional<std::size_t> {
+  const auto body = detail::unpadded_size(encoded);
+  if (!body) return std::nullopt;
+  return *body / 4 * 3 + (*body % 4 == 0 ? 0 : *body % 4 - 1);
+}
+
+/**
+ * Validate and decode `encoded` into `out`, which must hold `*decoded_size(encoded)` bytes.
+ * Returns false if `encoded` is malformed, in which case `out` holds partial output. `kernel` must
+ * be supported.
+ */
+inline auto decode(std::string_view encoded, void *out, Kernel kernel = Kernel::BEST) -> bool {
+  const auto unpadded = detail::unpadded_size(encoded);
+  if (!unpadded) return false;
+  const auto body = *unpadded;
+  const auto *in = encoded.data();
+  auto *bytes = static_cast<unsigned char *>(out);
+  std::optional<std::size_t> done;
+  switch (detail::resolve(kernel)) {
+#ifdef CPLIB_INITIALIZERS_BASE64_X86
+    case Kernel::AVX2:
+      done = detail::decode_avx2(in, body, bytes);
+      break;
+    case Kernel::SSE41:
+      done = detail::decode_sse41(in, body, bytes);
+      break;
+#endif
+    default:
+      done = detail::decode_scalar(in, body, bytes);
+      break;
+  }
+  if (!done) return false;
+  bytes += *done / 4 * 3;
+  const auto rest = body - *done;
+  if (rest == 0) return true;
+  std::uint32_t bits = 0;
+  for (std::size_t i = 0; i < rest; ++i) {
+    const auto value = detail::DECODE_TABLE[static_cast<unsigned char>(in[*done + i])];
+    if (value == detail::INVALID) return false;
+    bits |= static_cast<std::uint32_t>(value) << (18 - 6 * i);
+  }
+  bytes[0] = static_cast<unsigned char>(bits >> 16);
+  if (rest == 3) bytes[1] = static_cast<unsigned char>(bits >> 8);
+  return true;
+}
+
+inline auto decode(std::string_view encoded, Kernel kernel = Kernel::BEST)
+    -> std::optional<std::string> {
+  const auto size = decoded_size(encoded);
+  if (!size) return std::nullopt;
+  std::string out(*size, '\0');
+  if (!decode(encoded, out.data(), kernel)) return std::nullopt;
+  return out;
+}
+}  // namespace cplib_initializers::common::base64
+
+#endif
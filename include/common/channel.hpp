@@ -0,0 +1,837 @@
+/*
+ * This file is part of CPLibInitializers.
+ *
+ * CPLibInitializers is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * CPLibInitializers is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with
+ * CPLibInitializers. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file channel.hpp
+ *
+ * Contestant channel of the interactor initializers, installed when they are given `Options` or
+ * the environment asks for one of its features (see interactor.hpp).
+ *
+ * `to_user` is buffered and written out when the interactor flushes it, when it is about to block
+ * on `from_user`, when the buffer is full, or at exit, so an interactor that forgets to flush
+ * cannot deadlock. With `coalesce`, explicit flushes (`std::flush`, `std::endl`) are deferred to
+ * the other points, so an interactor that flushes after every token still costs one `write` per
+ * round.
+ *
+ * For query-heavy problems `from_user` can optionally busy-poll: it retries a non-blocking `read`,
+ * yielding the CPU in between, for a bounded spin budget before it sleeps in `poll`. This trades
+ * interactor CPU time for avoiding the scheduler wakeup on every round.
+ *
+ * With an idle timeout, `from_user` gives up once the interactor has been waiting for that long
+ * while the contestant has consumed everything sent to it and `/proc` shows it blocked on a read,
+ * i.e. both sides are blocked on each other (typically a contestant that forgot to flush). The
+ * interaction then ends with a wrong answer instead of running into the judge's wall-clock limit.
+ * A contestant that is still computing, or that cannot be inspected, is left to the time limit.
+ *
+ * Interactors that send large blocks can enable a write queue: `to_user` becomes non-blocking, and
+ * whatever the pipe does not accept is queued and drained whenever the interactor waits on
+ * `from_user`, so the contestant's output keeps being read while the interactor's is pending.
+ * Both pipes can also be enlarged with `F_SETPIPE_SZ`.
+ *
+ * Bulk data from a file, such as a slice of `inf`, can be forwarded to the contestant with
+ * `forward` and `forward_file`, in order with the buffered output but without copying it through
+ * the interactor.
+ *
+ * Setting a trace path records every `write` and `read` on the channel, see tracer.hpp. A channel
+ * can also record the exchanged bytes to a transcript, or replay one without a contestant, see
+ * transcript.hpp. An interactor can run as a server that starts warm sessions on request, see
+ * server.hpp.
+ */
+
+#ifndef CPLIB_INITIALIZERS_COMMON_CHANNEL_HPP_
+#define CPLIB_INITIALIZERS_COMMON_CHANNEL_HPP_
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <ios>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cplib.hpp"
+#include "placement.hpp"
+#include "profile.hpp"
+#include "server.hpp"
+#include "tracer.hpp"
+#include "transcript.hpp"
+
+namespace cplib_initializers::common::channel {
+
+struct Options {
+  // Capacity of the `to_user` buffer. A full buffer is written out without waiting for a read.
+  std::size_t buffer_size = 1 << 16;
+  // Defer explicit flushes of `to_user` until the interactor blocks on `from_user`. Only enable
+  // this if no flush has to reach the contestant before the interactor reads again.
+  bool coalesce = false;
+  // Busy-poll `from_user` for up to this long before sleeping in `poll`. Zero disables busy
+  // polling.
+  std::chrono::nanoseconds spin_budget{0};
+  // Adapt the spin phase to the contestant's observed response time, within `spin_budget`.
+  bool adaptive_spin = true;
+  // Report the contestant as idle after waiting this long for `from_user` data while it is blocked
+  // reading, with nothing left unread on `to_user`. The contestant is taken from
+  // `placement::CONTESTANT_PID_ENV` or found at the other end of `from_user`; if neither works, it
+  // is never reported. Zero disables idle detection.
+  std::chrono::milliseconds idle_timeout{0};
+  // Make `to_user` non-blocking and queue output the pipe cannot take yet, draining it while
+  // waiting on `from_user`. Note that `O_NONBLOCK` applies to the whole open file description.
+  bool write_queue = false;
+  // Resize both contestant pipes to this many bytes with `F_SETPIPE_SZ`. Zero keeps the system
+  // default; sizes above `/proc/sys/fs/pipe-max-size` need `CAP_SYS_RESOURCE` and are ignored.
+  std::size_t pipe_size = 0;
+  // CPU placement and scheduling policy of the interactor, applied when the channel is installed.
+  placement::Options placement{};
+  // Record a per-round latency trace to this file. When empty, the `CPLIB_INITIALIZERS_TRACE`
+  // environment variable is used instead; tracing is disabled if both are empty.
+  std::string trace_path{};
+  // Record the exchanged bytes to this transcript file. When empty, `CPLIB_INITIALIZERS_RECORD` is
+  // used instead.
+  std::string record_path{};
+  // Also keep the transcript in memory, available from `ToUserBuf::recorder()` once the channel is
+  // finished. This records a transcript even without a record path.
+  bool keep_transcript = false;
+  // Replay this transcript instead of talking to the contestant. When empty,
+  // `CPLIB_INITIALIZERS_REPLAY` is used instead. The channel's file descriptors are not touched
+  // while replaying.
+  std::string replay_path{};
+  // Serve sessions from a warm process instead of running a single one, see server.hpp. When
+  // `server.socket_path` is empty, `CPLIB_INITIALIZERS_SERVER` is used instead. Only platforms that
+  // report on stderr can serve sessions, see `common::interactor::Initializer::allow_sessions`.
+  server::Options server{};
+};
+
+constexpr std::string_view TRACE_PATH_ENV = "CPLIB_INITIALIZERS_TRACE";
+constexpr std::string_view RECORD_PATH_ENV = "CPLIB_INITIALIZERS_RECORD";
+constexpr std::string_view REPLAY_PATH_ENV = "CPLIB_INITIALIZERS_REPLAY";
+
+class ToUserBuf;
+
+namespace detail {
+inline std::vector<ToUserBuf *> exit_flush_targets;
+
+inline auto write_all(int fd, const char *data, std::size_t size) -> bool {
+  while (size > 0) {
+    auto written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += written;
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+// Best effort: the descriptor may not be a pipe, or the size may exceed the unprivileged limit.
+inline auto set_pipe_size(int fd, std::size_t size) -> void {
+#ifdef F_SETPIPE_SZ
+  if (size > 0) fcntl(fd, F_SETPIPE_SZ, static_cast<int>(std::min<std::size_t>(size, 1 << 30)));
+#endif
+}
+
+// Bytes in a pipe that have not been read yet, or zero if unknown.
+inline auto unread(int fd) -> int {
+  int unread = 0;
+  if (ioctl(fd, FIONREAD, &unread) != 0) return 0;
+  return unread;
+}
+
+inline auto set_nonblocking(int fd) -> bool {
+  auto flags = fcntl(fd, F_GETFL);
+  return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+}  // namespace detail
+
+class ToUserBuf : public std::streambuf {
+ public:
+  ToUserBuf(int fd, const Options &options)
+      : fd_(fd),
+        coalesce_(options.coalesce),
+        queue_writes_(options.write_queue && options.replay_path.empty() &&
+                      detail::set_nonblocking(fd)),
+        buffer_(std::max<std::size_t>(options.buffer_size, 1)) {
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    if (options.replay_path.empty()) detail::set_pipe_size(fd_, options.pipe_size);
+    if (!options.trace_path.empty()) {
+      tracer_ = std::make_unique<tracer::Tracer>(options.trace_path);
+    }
+    if (!options.record_path.empty() || options.keep_transcript) {
+      recorder_ =
+          std::make_unique<transcript::Recorder>(options.record_path, options.keep_transcript);
+    }
+    if (!options.replay_path.empty()) {
+      auto loaded = transcript::load(options.replay_path);
+      if (!loaded.has_value()) {
+        cplib::panic(std::format("replay: cannot load transcript {}", options.replay_path));
+      }
+      replay_ = std::make_unique<transcript::Replay>(std::move(*loaded));
+    }
+  }
+
+  ToUserBuf(const ToUserBuf &) = delete;
+  auto operator=(const ToUserBuf &) -> ToUserBuf & = delete;
+
+  ~ToUserBuf() override {
+    finish();
+    std::erase(detail::exit_flush_targets, this);
+  }
+
+  [[nodiscard]] auto fd() const -> int { return fd_; }
+
+  [[nodiscard]] auto tracer() const -> tracer::Tracer * { return tracer_.get(); }
+
+  [[nodiscard]] auto recorder() const -> transcript::Recorder * { return recorder_.get(); }
+
+  [[nodiscard]] auto replay() const -> transcript::Replay * { return replay_.get(); }
+
+  [[nodiscard]] auto pending() const -> std::size_t {
+    return static_cast<std::size_t>(pptr() - pbase());
+  }
+
+  // Bytes handed to the write queue that the pipe has not accepted yet.
+  [[nodiscard]] auto queued() const -> std::size_t { return queue_.size() - queue_head_; }
+
+  // Write out everything buffered so far, or hand it to the write queue. Once a write fails
+  // (usually because the contestant has exited), further output is discarded.
+  auto flush() -> bool {
+    if (failed_) {
+      setp(buffer_.data(), buffer_.data() + buffer_.size());
+      return false;
+    }
+    if (pending() > 0) write_out(pbase(), pending());
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    return !failed_;
+  }
+
+  // Write as much of the queue as the pipe accepts without blocking.
+  auto drain() -> bool {
+    if (queued() == 0) return !failed_;
+    auto written = write_some(queue_.data() + queue_head_, queued());
+    if (written < 0) return false;
+    queue_head_ += static_cast<std::size_t>(written);
+    if (queue_head_ == queue_.size()) {
+      queue_.clear();
+      queue_head_ = 0;
+    } else if (queue_head_ >= queue_.size() / 2) {
+      queue_.erase(0, queue_head_);
+      queue_head_ = 0;
+    }
+    return true;
+  }
+
+  /**
+   * Send `size` bytes of the file `file_fd` from `offset` to the contestant, after all output
+   * written so far. The kernel copies the data with `sendfile`, except where it has to pass through
+   * this process: when it is recorded or replayed, once the write queue holds data, and where
+   * `sendfile` is not supported. Stops early at the end of the file.
+   */
+  auto forward(int file_fd, off_t offset, std::size_t size) -> bool {
+    if (!flush()) return false;
+    if (replay_ == nullptr && recorder_ == nullptr && queued() == 0) {
+      while (size > 0) {
+        auto sent = sendfile(fd_, file_fd, &offset, std::min<std::size_t>(size, 1 << 30));
+        if (sent < 0) {
+          if (errno == EINTR) continue;
+          // A full non-blocking pipe: queue the rest. Unsupported descriptors: copy the rest.
+          if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINVAL || errno == ENOSYS) break;
+          failed_ = true;
+          return false;
+        }
+        if (sent == 0) return true;
+        if (tracer_ != nullptr) tracer_->record(tracer::EventKind::TO_USER, sent);
+        size -= static_cast<std::size_t>(sent);
+      }
+    }
+
+    std::vector<char> chunk(std::min<std::size_t>(size, 1 << 16));
+    while (size > 0) {
+      auto got = pread(file_fd, chunk.data(), std::min(size, chunk.size()), offset);
+      if (got < 0 && errno == EINTR) continue;
+      if (got <= 0) break;
+      if (!write_out(chunk.data(), static_cast<std::size_t>(got))) return false;
+      offset += got;
+      size -= static_cast<std::size_t>(got);
+    }
+    return !failed_;
+  }
+
+  // Flush, wait until the queue is drained and close the trace and transcript, if any. Called at
+  // exit.
+  auto finish() -> void {
+    // The verdict is already known here; output diverging from a replayed transcript cannot
+    // change it anymore.
+    finishing_ = true;
+    flush();
+    while (queued() > 0 && drain()) {
+      if (queued() == 0) break;
+      pollfd entry{fd_, POLLOUT, 0};
+      poll(&entry, 1, -1);
+    }
+    if (tracer_ != nullptr) tracer_->finish();
+    if (recorder_ != nullptr) recorder_->finish();
+  }
+
+ protected:
+  auto overflow(int_type ch) -> int_type override {
+    if (!flush()) return traits_type::eof();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(ch);
+      pbump(1);
+    }
+    return traits_type::not_eof(ch);
+  }
+
+  auto xsputn(const char *s, std::streamsize n) -> std::streamsize override {
+    auto size = static_cast<std::size_t>(n);
+    if (size <= static_cast<std::size_t>(epptr() - pptr())) {
+      std::memcpy(pptr(), s, size);
+      pbump(static_cast<int>(size));
+      return n;
+    }
+    if (!flush()) return 0;
+    if (size >= buffer_.size()) return write_out(s, size) ? n : 0;
+    std::memcpy(pptr(), s, size);
+    pbump(static_cast<int>(size));
+    return n;
+  }
+
+  auto sync() -> int override {
+    if (coalesce_) return failed_ ? -1 : 0;
+    return flush() ? 0 : -1;
+  }
+
+ private:
+  auto write_out(const char *data, std::size_t size) -> bool {
+    if (replay_ != nullptr) {
+      if (!replay_->expect({data, size}) && !finishing_) {
+        cplib::panic(std::format("replay: to_user diverges from the transcript at byte {}",
+                                 replay_->written()));
+      }
+      return true;
+    }
+    if (queue_writes_) {
+      // Keep the output in order: nothing bypasses a non-empty queue.
+      if (queued() == 0) {
+        auto written = write_some(data, size);
+        if (written < 0) return false;
+        data += written;
+        size -= static_cast<std::size_t>(written);
+      }
+      queue_.append(data, size);
+      return true;
+    }
+    if (!detail::write_all(fd_, data, size)) {
+      failed_ = true;
+      return false;
+    }
+    on_written(data, size);
+    return true;
+  }
+
+  auto on_written(const char *data, std::size_t size) -> void {
+    if (tracer_ != nullptr) tracer_->record(tracer::EventKind::TO_USER, size);
+    if (recorder_ != nullptr) recorder_->record(transcript::ChunkKind::TO_USER, {data, size});
+  }
+
+  // Non-blocking writes until the pipe is full. Returns the number of bytes written, or -1 if the
+  // channel failed.
+  auto write_some(const char *data, std::size_t size) -> ssize_t {
+    std::size_t total = 0;
+    while (total < size) {
+      auto written = ::write(fd_, data + total, size - total);
+      if (written < 0) {
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        failed_ = true;
+        queue_.clear();
+        queue_head_ = 0;
+        return -1;
+      }
+      on_written(data + total, static_cast<std::size_t>(written));
+      total += static_cast<std::size_t>(written);
+    }
+    return static_cast<ssize_t>(total);
+  }
+
+  int fd_;
+  bool coalesce_;
+  bool queue_writes_;
+  bool failed_{};
+  bool finishing_{};
+  std::vector<char> buffer_;
+  std::string queue_;
+  std::size_t queue_head_{};
+  std::unique_ptr<tracer::Tracer> tracer_;
+  std::unique_ptr<transcript::Recorder> recorder_;
+  std::unique_ptr<transcript::Replay> replay_;
+};
+
+class FromUserBuf : public std::streambuf {
+ public:
+  FromUserBuf(int fd, ToUserBuf *to_user, const Options &options)
+      : fd_(fd),
+        to_user_(to_user),
+        tracer_(to_user != nullptr ? to_user->tracer() : nullptr),
+        recorder_(to_user != nullptr ? to_user->recorder() : nullptr),
+        replay_(to_user != nullptr ? to_user->replay() : nullptr),
+        spin_budget_(std::max(options.spin_budget, std::chrono::nanoseconds::zero())),
+        spin_limit_(spin_budget_),
+        adaptive_spin_(options.adaptive_spin),
+        idle_timeout_(std::max(options.idle_timeout, std::chrono::milliseconds::zero())),
+        buffer_(1 << 16) {
+    setg(buffer_.data(), buffer_.data(), buffer_.data());
+    if (replay_ != nullptr) {
+      spin_budget_ = spin_limit_ = std::chrono::nanoseconds::zero();
+      return;
+    }
+    detail::set_pipe_size(fd_, options.pipe_size);
+    if (spin_budget_.count() > 0 && !detail::set_nonblocking(fd_)) {
+      spin_budget_ = spin_limit_ = std::chrono::nanoseconds::zero();
+    }
+  }
+
+  FromUserBuf(const FromUserBuf &) = delete;
+  auto operator=(const FromUserBuf &) -> FromUserBuf & = delete;
+
+  [[nodiscard]] auto fd() const -> int { return fd_; }
+
+  // Current length of the spin phase; equal to the spin budget unless adaptive spinning shrank it.
+  [[nodiscard]] auto spin_limit() const -> std::chrono::nanoseconds { return spin_limit_; }
+
+  // Also flush `to_user` before blocking, for interactors talking to several processes.
+  auto flush_before_read(ToUserBuf *to_user) -> void { flush_targets_.push_back(to_user); }
+
+  // Send everything the contestant may need before it can answer.
+  auto flush_to_user() -> void {
+    if (to_user_ != nullptr) to_user_->flush();
+    for (auto *target : flush_targets_) target->flush();
+  }
+
+  /**
+   * Whether a complete line, a full buffer or the end of input is available, so that reading up
+   * to the next line break does not block. Whitespace before the line, such as the line break left
+   * behind by the previous token, does not count. Reads whatever the contestant has already sent
+   * without waiting for more.
+   */
+  auto line_ready() -> bool {
+    if (replay_ != nullptr) return true;
+    while (true) {
+      const auto available = static_cast<std::size_t>(egptr() - gptr());
+      auto *line = std::find_if(gptr(), egptr(), [](char ch) {
+        return std::isspace(static_cast<unsigned char>(ch)) == 0;
+      });
+      if (std::find(line, egptr(), '\n') != egptr()) return true;
+
+      if (gptr() != buffer_.data()) {
+        std::memmove(buffer_.data(), gptr(), available);
+        setg(buffer_.data(), buffer_.data(), buffer_.data() + available);
+      }
+      if (available == buffer_.size()) return true;
+
+      pollfd entry{fd_, POLLIN, 0};
+      if (poll(&entry, 1, 0) <= 0) return false;
+      auto size = ::read(fd_, egptr(), buffer_.size() - available);
+      if (size < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+      on_read(egptr(), size);
+      if (size <= 0) return true;
+      setg(buffer_.data(), buffer_.data(), egptr() + size);
+    }
+  }
+
+  // Called with the idle timeout when the contestant is found idle. Without a handler, or if it
+  // returns, `from_user` reports end of file.
+  auto set_idle_handler(std::function<void(std::chrono::milliseconds)> handler) -> void {
+    idle_handler_ = std::move(handler);
+  }
+
+ protected:
+  auto underflow() -> int_type override {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+    // The contestant cannot answer what it has not received yet.
+    flush_to_user();
+
+    ssize_t size;
+    if (replay_ != nullptr) {
+      size = read_replay();
+    } else {
+      size = spin_budget_.count() > 0 ? read_spinning() : read_blocking();
+      on_read(buffer_.data(), size);
+    }
+    if (size <= 0) return traits_type::eof();
+
+    setg(buffer_.data(), buffer_.data(), buffer_.data() + size);
+    return traits_type::to_int_type(*gptr());
+  }
+
+ private:
+  auto on_read(const char *data, ssize_t size) -> void {
+    profile::count_from_user(size);
+    if (size > 0 && tracer_ != nullptr) {
+      tracer_->record(tracer::EventKind::FROM_USER, static_cast<std::size_t>(size));
+    }
+    if (recorder_ == nullptr) return;
+    if (size > 0) {
+      recorder_->record(transcript::ChunkKind::FROM_USER, {data, static_cast<std::size_t>(size)});
+    } else if (size == 0 && !recorded_eof_) {
+      recorder_->record(transcript::ChunkKind::FROM_USER_EOF, {});
+      recorded_eof_ = true;
+    }
+  }
+
+  auto read_replay() -> ssize_t {
+    auto size = replay_->read(buffer_.data(), buffer_.size());
+    if (size == 0 && !replay_->from_user_eof()) {
+      cplib::panic("replay: the interactor reads past the recorded from_user stream");
+    }
+    return static_cast<ssize_t>(size);
+  }
+
+  auto read_blocking() -> ssize_t {
+    if ((idle_timeout_.count() > 0 || to_user_queued()) && !wait_readable()) return report_idle();
+    ssize_t size;
+    do {
+      size = ::read(fd_, buffer_.data(), buffer_.size());
+    } while (size < 0 && errno == EINTR);
+    return size;
+  }
+
+  auto read_spinning() -> ssize_t {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const auto deadline = start + spin_limit_;
+    bool spinning = true;
+
+    while (true) {
+      auto size = ::read(fd_, buffer_.data(), buffer_.size());
+      if (size >= 0) {
+        adapt_spin_limit(Clock::now() - start);
+        return size;
+      }
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK) return size;
+
+      if (spinning && Clock::now() < deadline) {
+        if (to_user_queued()) to_user_->drain();
+        // Yield rather than pause so a contestant sharing this CPU can still run.
+        sched_yield();
+        continue;
+      }
+      spinning = false;
+      if (!wait_readable()) return report_idle();
+    }
+  }
+
+  [[nodiscard]] auto to_user_queued() const -> bool {
+    return to_user_ != nullptr && to_user_->queued() > 0;
+  }
+
+  // Wait until `from_user` is readable, draining the `to_user` queue meanwhile. Returns false if
+  // the contestant is idle: nothing arrived within the idle timeout and everything written to
+  // `to_user` has been read.
+  auto wait_readable() -> bool {
+    using Clock = std::chrono::steady_clock;
+    auto deadline = Clock::now() + idle_timeout_;
+    while (true) {
+      int timeout = -1;
+      if (idle_timeout_.count() > 0) {
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now());
+        timeout = static_cast<int>(std::max<std::chrono::milliseconds::rep>(remaining.count(), 0));
+      }
+      std::array<pollfd, 2> entries{{{fd_, POLLIN, 0}, {-1, POLLOUT, 0}}};
+      if (to_user_queued()) entries[1].fd = to_user_->fd();
+      auto ready = poll(entries.data(), entries.size(), timeout);
+      if (ready < 0) {
+        if (errno == EINTR) continue;
+        return true;
+      }
+      if (entries[0].revents != 0) return true;
+      if (entries[1].revents != 0) {
+        // The contestant is consuming our output, so it is not idle.
+        to_user_->drain();
+        deadline = Clock::now() + idle_timeout_;
+        continue;
+      }
+      if (Clock::now() < deadline) continue;
+      // Only a contestant blocked on a read is waiting on us. One that is still computing or has
+      // input left to read is busy, and runs into the judge's time limit if it never answers.
+      if (to_user_unread() == 0 && contestant_waiting()) return false;
+      deadline = Clock::now() + idle_timeout_;
+    }
+  }
+
+  // Bytes written to `to_user` that the contestant has not read yet, or zero if unknown.
+  [[nodiscard]] auto to_user_unread() const -> int {
+    return to_user_ != nullptr ? detail::unread(to_user_->fd()) : 0;
+  }
+
+  // Whether the contestant is blocked reading, as far as `/proc` shows. The contestant is looked
+  // up once, on the first check.
+  auto contestant_waiting() -> bool {
+    if (!contestant_pid_.has_value()) {
+      contestant_pid_ = placement::detail::contestant_pid(fd_).value_or(-1);
+    }
+    return *contestant_pid_ > 0 && placement::detail::blocked_on_read(*contestant_pid_);
+  }
+
+  auto report_idle() -> ssize_t {
+    if (idle_handler_) idle_handler_(idle_timeout_);
+    return 0;
+  }
+
+  // Spin for about twice the latest response time while responses arrive within the budget, and
+  // back off exponentially while they do not.
+  auto adapt_spin_limit(std::chrono::nanoseconds waited) -> void {
+    if (!adaptive_spin_) return;
+    const auto floor =
+        std::min(std::max(spin_budget_ / 64, std::chrono::nanoseconds(1000)), spin_budget_);
+    if (waited <= spin_budget_) {
+      spin_limit_ = std::clamp(std::chrono::nanoseconds(waited * 2), floor, spin_budget_);
+    } else {
+      spin_limit_ = std::max(spin_limit_ / 2, floor);
+    }
+  }
+
+  int fd_;
+  ToUserBuf *to_user_;
+  std::vector<ToUserBuf *> flush_targets_;
+  tracer::Tracer *tracer_;
+  transcript::Recorder *recorder_;
+  transcript::Replay *replay_;
+  bool recorded_eof_{};
+  std::chrono::nanoseconds spin_budget_;
+  std::chrono::nanoseconds spin_limit_;
+  bool adaptive_spin_;
+  std::chrono::milliseconds idle_timeout_;
+  std::optional<int> contestant_pid_;
+  std::function<void(std::chrono::milliseconds)> idle_handler_;
+  std::vector<char> buffer_;
+};
+
+namespace detail {
+inline auto flush_at_exit() -> void {
+  for (auto *target : exit_flush_targets) target->finish();
+}
+
+inline auto register_exit_flush(ToUserBuf *to_user) -> void {
+  static const bool registered = std::atexit(flush_at_exit) == 0;
+  static_cast<void>(registered);
+  exit_flush_targets.push_back(to_user);
+}
+
+inline std::vector<std::pair<const cplib::var::Reader *, FromUserBuf *>> readers;
+
+inline auto register_reader(const cplib::var::Reader *reader, FromUserBuf *buf) -> void {
+  std::erase_if(readers, [reader](const auto &entry) { return entry.first == reader; });
+  if (buf != nullptr) readers.emplace_back(reader, buf);
+}
+
+inline auto idle_message(std::chrono::milliseconds timeout) -> std::string {
+  return std::format("idle: no data for {} ms while awaiting response", timeout.count());
+}
+
+inline auto make_reader(cplib::interactor::State &state, std::unique_ptr<FromUserBuf> buf,
+                        std::string name, cplib::trace::Level trace_level) -> cplib::var::Reader {
+  buf->set_idle_handler(
+      [&state](std::chrono::milliseconds timeout) { state.quit_wa(idle_message(timeout)); });
+  return {std::make_unique<cplib::io::InStream>(std::move(buf), std::move(name), false),
+          trace_level,
+          [&state, trace_level](const cplib::var::Reader &reader, std::string_view msg) {
+            if (trace_level >= cplib::trace::Level::STACK_ONLY) {
+              state.reporter->attach_trace_stack(reader.make_trace_stack(false));
+            }
+            state.quit_wa(msg);
+          }};
+}
+}  // namespace detail
+
+// The channel buffer behind a `from_user` reader set up by this module, or null.
+inline auto from_user_buf(const cplib::var::Reader &reader) -> FromUserBuf * {
+  for (const auto &[registered, buf] : detail::readers) {
+    if (registered == &reader) return buf;
+  }
+  return nullptr;
+}
+
+// The channel buffer behind a `to_user` stream set up by this module, or null.
+inline auto to_user_buf(const std::ostream &to_user) -> ToUserBuf * {
+  return dynamic_cast<ToUserBuf *>(to_user.rdbuf());
+}
+
+/**
+ * Send `size` bytes of the file `file_fd` from `offset` to the contestant, in order with the
+ * output written to `to_user` so far, see `ToUserBuf::forward`. Streams that are not a contestant
+ * channel get a copy of the data. Returns false if the contestant channel has failed.
+ */
+inline auto forward(std::ostream &to_user, int file_fd, off_t offset, std::size_t size) -> bool {
+  if (auto *buf = to_user_buf(to_user)) return buf->forward(file_fd, offset, size);
+  std::vector<char> chunk(std::min<std::size_t>(size, 1 << 16));
+  while (size > 0) {
+    auto got = pread(file_fd, chunk.data(), std::min(size, chunk.size()), offset);
+    if (got < 0 && errno == EINTR) continue;
+    if (got <= 0) break;
+    to_user.write(chunk.data(), got);
+    offset += got;
+    size -= static_cast<std::size_t>(got);
+  }
+  return static_cast<bool>(to_user);
+}
+
+// Send the file at `path` from `offset`, up to `size` bytes or to its end, see `forward`.
+inline auto forward_file(std::ostream &to_user, const std::string &path, off_t offset = 0,
+                         std::optional<std::size_t> size = std::nullopt) -> bool {
+  const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat info{};
+  if (fd < 0 || fstat(fd, &info) != 0) {
+    if (fd >= 0) close(fd);
+    cplib::panic(std::format("forward_file: cannot open {}", path));
+  }
+  const auto available = static_cast<std::size_t>(std::max<off_t>(info.st_size - offset, 0));
+  const auto ok = forward(to_user, fd, offset, std::min(size.value_or(available), available));
+  close(fd);
+  return ok;
+}
+
+// Whether one of the environment variables that `resolve_options` reads is set.
+inline auto requested_by_env() -> bool {
+  for (const auto name : {TRACE_PATH_ENV, RECORD_PATH_ENV, REPLAY_PATH_ENV, server::SOCKET_ENV}) {
+    if (const auto *env = std::getenv(name.data()); env != nullptr && *env != '\0') return true;
+  }
+  return false;
+}
+
+// Fill in settings taken from the environment.
+inline auto resolve_options(Options options) -> Options {
+  const auto from_env = [](std::string &value, std::string_view name) {
+    if (!value.empty()) return;
+    if (const auto *env = std::getenv(name.data()); env != nullptr) value = env;
+  };
+  from_env(options.trace_path, TRACE_PATH_ENV);
+  from_env(options.record_path, RECORD_PATH_ENV);
+  from_env(options.replay_path, REPLAY_PATH_ENV);
+  from_env(options.server.socket_path, server::SOCKET_ENV);
+  return options;
+}
+
+/**
+ * Install the contestant channel on an interactor state.
+ *
+ * `from_user` is replaced by a reader over `from_user_fd` and `to_user` by a buffer over
+ * `to_user_fd`. The returned buffer must be kept alive as long as `state.to_user` is used.
+ *
+ * Pending output is flushed and the trace, if any, is finished by an `atexit` handler registered
+ * here, so anything that closes the `to_user` descriptor at exit (such as `spoj_init`) must be
+ * called before this function.
+ *
+ * The first overload installs buffers built by the caller, with options already resolved. With a
+ * server socket configured, the second overload serves sessions first and returns in the process of
+ * each session, with the session's descriptors in place of `from_user_fd`, `to_user_fd` and stderr.
+ * A session's trace and transcript paths get its process ID appended, e.g. `trace.1234`.
+ */
+inline auto install(cplib::interactor::State &state, std::unique_ptr<FromUserBuf> from_user,
+                    ToUserBuf *to_user, cplib::trace::Level trace_level) -> void {
+  detail::register_reader(&state.from_user, from_user.get());
+  state.from_user = detail::make_reader(state, std::move(from_user), "from_user", trace_level);
+  state.to_user.rdbuf(to_user);
+  detail::register_exit_flush(to_user);
+}
+
+inline auto install(cplib::interactor::State &state, int from_user_fd, int to_user_fd,
+                    cplib::trace::Level trace_level, const Options &options)
+    -> std::unique_ptr<ToUserBuf> {
+  auto resolved = resolve_options(options);
+  if (!resolved.server.socket_path.empty()) {
+    if (!server::serve(resolved.server, {from_user_fd, to_user_fd, STDERR_FILENO})) {
+      cplib::panic("server: cannot listen on " + resolved.server.socket_path);
+    }
+    // Sessions run side by side, so each one traces and records to a file of its own.
+    for (auto *path : {&resolved.trace_path, &resolved.record_path}) {
+      if (!path->empty()) *path += std::format(".{}", getpid());
+    }
+  }
+  placement::apply(resolved.placement, from_user_fd);
+  auto to_user = std::make_unique<ToUserBuf>(to_user_fd, resolved);
+  install(state, std::make_unique<FromUserBuf>(from_user_fd, to_user.get(), resolved),
+          to_user.get(), trace_level);
+  return to_user;
+}
+
+/**
+ * A contestant channel that is not bound to the interactor state, for tasks with several
+ * contestant processes. Read failures and idle contestants are reported on `state` like those of
+ * an installed channel, and pending output is flushed at exit. `options` is used as is; see
+ * `resolve_options`.
+ */
+class Channel {
+ public:
+  Channel(cplib::interactor::State &state, int from_user_fd, int to_user_fd,
+          const std::string &name, cplib::trace::Level trace_level, const Options &options)
+      : to_user_buf_(std::make_unique<ToUserBuf>(to_user_fd, options)),
+        from_user_(detail::make_reader(
+            state, make_from_user_buf(from_user_fd, options), "from_user_" + name, trace_level)),
+        to_user_(to_user_buf_.get()) {
+    detail::register_exit_flush(to_user_buf_.get());
+    detail::register_reader(&from_user_, from_user_buf_);
+  }
+
+  Channel(const Channel &) = delete;
+  auto operator=(const Channel &) -> Channel & = delete;
+
+  ~Channel() { detail::register_reader(&from_user_, nullptr); }
+
+  [[nodiscard]] auto from_user() -> cplib::var::Reader & { return from_user_; }
+
+  [[nodiscard]] auto to_user() -> std::ostream & { return to_user_; }
+
+  [[nodiscard]] auto to_user_buf() const -> ToUserBuf * { return to_user_buf_.get(); }
+
+  [[nodiscard]] auto from_user_buf() const -> FromUserBuf * { return from_user_buf_; }
+
+ private:
+  auto make_from_user_buf(int fd, const Options &options) -> std::unique_ptr<FromUserBuf> {
+    auto buf = std::make_unique<FromUserBuf>(fd, to_user_buf_.get(), options);
+    from_user_buf_ = buf.get();
+    return buf;
+  }
+
+  std::unique_ptr<ToUserBuf> to_user_buf_;
+  FromUserBuf *from_user_buf_{};
+  cplib::var::Reader from_user_;
+  std::ostream to_user_;
+};
+}  // namespace cplib_initializers::common::channel
+
+#endif
@@ -0,0 +1,125 @@
+/*
+ * This file is part of CPLibInitializers.
+ *
+ * CPLibInitializers is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * CPLibInitializers is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with
+ * CPLibInitializers. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file checker.hpp
+ *
+ * Base of the checker initializers.
+ *
+ * On top of the profile of profile.hpp, it limits the size of the output: output of more than
+ * `Options::max_ouf_bytes` is judged WRONG_ANSWER through the platform's reporter before the
+ * excess is parsed. A regular file is sized with `fstat` before its first byte is read; a pipe is
+ * counted as it arrives and cut off once it goes over. There is no limit unless the problem sets
+ * one.
+ *
+ * Platforms that only tell ACCEPTED apart from anything else can also enable early exit, which
+ * lets checkers stop at the first mismatch through `quit_unless_accepted`.
+ */
+
+#ifndef CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_
+#define CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_
+
+#include <cstdint>
+#include <format>
+#include <string>
+#include <string_view>
+
+#include "cplib.hpp"
+#include "profile.hpp"
+
+namespace cplib_initializers::common::checker {
+
+namespace detail {
+inline auto size_message(std::uint64_t limit) -> std::string {
+  return std::format("Output exceeds the limit of {} bytes", limit);
+}
+
+inline bool early_exit = false;
+inline cplib::checker::State *state = nullptr;
+}  // namespace detail
+
+/**
+ * Whether the checker may stop at the first mismatch. On a platform that enables it, partial
+ * scores and the rest of the output cannot turn a mismatch into ACCEPTED.
+ */
+inline auto early_exit() -> bool { return detail::early_exit; }
+
+/**
+ * Whether a platform that only tells ACCEPTED apart from anything else accepts a result with
+ * `status` and `score`: an ACCEPTED status or a full score, so PARTIALLY_CORRECT with score 1.0
+ * is accepted as well. Such platforms report their verdict by this rule, and
+ * `quit_unless_accepted` stops by it.
+ */
+template <class Status>
+constexpr auto counts_as_accepted(Status status, double score) -> bool {
+  return status == Status::ACCEPTED || score == 1.0;
+}
+
+/**
+ * With early exit, end the check with WRONG_ANSWER unless `result` counts as accepted, see
+ * `counts_as_accepted`. Otherwise return `result`. Call it on intermediate results, e.g. per case
+ * of a multi-case output, to skip evaluating and reading the rest of the output.
+ */
+inline auto quit_unless_accepted(const cplib::evaluate::Result &result)
+    -> const cplib::evaluate::Result & {
+  if (detail::early_exit && detail::state != nullptr &&
+      !counts_as_accepted(result.status, result.score)) {
+    detail::state->quit_wa(result.message);
+  }
+  return result;
+}
+
+// Options the checker initializers take, e.g. `Initializer({.max_ouf_bytes = 64 << 20})`.
+struct Options {
+  // Output of more than this many bytes is judged WRONG_ANSWER before it is read, 0 for no limit.
+  std::uint64_t max_ouf_bytes = 0;
+};
+
+struct Initializer : profile::Profiled<cplib::checker::Initializer> {
+  Options checker_options;
+
+  Initializer() = default;
+
+  explicit Initializer(Options checker_options) : checker_options(checker_options) {}
+
+ protected:
+  // Let `quit_unless_accepted` end the check, see `early_exit`.
+  auto enable_early_exit(bool enabled) -> void {
+    detail::early_exit = enabled;
+    detail::state = &Profiled::state();
+  }
+
+  auto set_ouf_fileno(int fd, cplib::trace::Level trace_level) -> void {
+    if (checker_options.max_ouf_bytes == 0) return Profiled::set_ouf_fileno(fd, trace_level);
+    set_limited_ouf(fd, false, trace_level);
+  }
+
+  auto set_ouf_path(std::string_view path, cplib::trace::Level trace_level) -> void {
+    if (checker_options.max_ouf_bytes == 0) return Profiled::set_ouf_path(path, trace_level);
+    set_limited_ouf(profile::detail::open_path(path), true, trace_level);
+  }
+
+ private:
+  // The check happens on the first read, once the platform's reporter is in place.
+  auto set_limited_ouf(int fd, bool owned, cplib::trace::Level trace_level) -> void {
+    auto &state = Profiled::state();
+    const auto limit = checker_options.max_ouf_bytes;
+    install(state.ouf, profile::Stream::OUF, fd, owned, trace_level, limit,
+            [&state, limit] { state.quit_wa(detail::size_message(limit)); });
+  }
+};
+}  // namespace cplib_initializers::common::checker
+
+#endif
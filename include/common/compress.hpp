@@ -0,0 +1,165 @@
+/*
+ * This file is part of CPLibInitializers.
+ *
+ * CPLibInitializers is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * CPLibInitializers is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with
+ * CPLibInitializers. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file compress.hpp
+ *
+ * A small LZ77 compressor for transcripts, which repeat the same queries and answers over and over.
+ * It favors speed over ratio and needs no external library.
+ *
+ * Layout: independent blocks of up to `BLOCK_SIZE` bytes, each a LEB128 uncompressed size, a
+ * LEB128 compressed size and the compressed sequences. A sequence is a LEB128 literal count, the
+ * literals, a LEB128 match length and, unless the length is zero, which ends the block, a LEB128
+ * distance back into the block's output.
+ */
+
+#ifndef CPLIB_INITIALIZERS_COMMON_COMPRESS_HPP_
+#define CPLIB_INITIALIZERS_COMMON_COMPRESS_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cplib_initializers::common::compress {
+
+constexpr std::size_t BLOCK_SIZE = 1 << 20;
+
+namespace detail {
+constexpr std::size_t MIN_MATCH = 4;
+constexpr int HASH_BITS = 14;
+constexpr std::uint32_t NO_POSITION = UINT32_MAX;
+
+inline auto write_varint(std::uint64_t value, std::string &out) -> void {
+  do {
+    auto byte = static_cast<std::uint8_t>(value & 0x7f);
+    value >>= 7;
+    if (value != 0) byte |= 0x80;
+    out.push_back(static_cast<char>(byte));
+  } while (value != 0);
+}
+
+inline auto read_varint(std::string_view data, std::size_t &pos) -> std::optional<std::uint64_t> {
+  std::uint64_t value = 0;
+  for (int shift = 0;; shift += 7) {
+    if (pos >= data.size() || shift > 63) return std::nullopt;
+    const auto byte = static_cast<std::uint8_t>(data[pos++]);
+    value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) return value;
+  }
+}
+
+inline auto hash(const char *data) -> std::size_t {
+  std::uint32_t word = 0;
+  std::memcpy(&word, data, sizeof(word));
+  return (word * 2654435761U) >> (32 - HASH_BITS);
+}
+
+inline auto compress_block(std::string_view block, std::vector<std::uint32_t> &table,
+                           std::string &out) -> void {
+  std::ranges::fill(table, NO_POSITION);
+  std::size_t anchor = 0;
+  std::size_t pos = 0;
+  while (pos + MIN_MATCH <= block.size()) {
+    auto &slot = table[hash(block.data() + pos)];
+    const auto candidate = slot;
+    slot = static_cast<std::uint32_t>(pos);
+    if (candidate == NO_POSITION ||
+        std::memcmp(block.data() + candidate, block.data() + pos, MIN_MATCH) != 0) {
+      ++pos;
+      continue;
+    }
+    auto length = MIN_MATCH;
+    while (pos + length < block.size() && block[candidate + length] == block[pos + length]) {
+      ++length;
+    }
+    write_varint(pos - anchor, out);
+    out.append(block.substr(anchor, pos - anchor));
+    write_varint(length, out);
+    write_varint(pos - candidate, out);
+    pos += length;
+    anchor = pos;
+  }
+  write_varint(block.size() - anchor, out);
+  out.append(block.substr(anchor));
+  write_varint(0, out);
+}
+
+inline auto decompress_block(std::string_view block, std::size_t size, std::string &out) -> bool {
+  const auto start = out.size();
+  std::size_t pos = 0;
+  while (true) {
+    const auto literals = read_varint(block, pos);
+    if (!literals || *literals > block.size() - pos || *literals > size - (out.size() - start)) {
+      return false;
+    }
+    out.append(block.substr(pos, *literals));
+    pos += *literals;
+    const auto length = read_varint(block, pos);
+    if (!length) return false;
+    if (*length == 0) break;
+    const auto distance = read_varint(block, pos);
+    if (!distance || *distance == 0 || *distance > out.size() - start ||
+        *length > size - (out.size() - start)) {
+      return false;
+    }
+    // The match may overlap the bytes it produces.
+    for (auto i = *length; i > 0; --i) {
+      const auto byte = out[out.size() - *distance];
+      out.push_back(byte);
+    }
+  }
+  return pos == block.size() && out.size() - start == size;
+}
+}  // namespace detail
+
+inline auto compress(std::string_view data) -> std::string {
+  std::string out;
+  std::vector<std::uint32_t> table(std::size_t{1} << detail::HASH_BITS);
+  std::string block;
+  for (std::size_t pos = 0; pos < data.size(); pos += BLOCK_SIZE) {
+    const auto raw = data.substr(pos, BLOCK_SIZE);
+    block.clear();
+    detail::compress_block(raw, table, block);
+    detail::write_varint(raw.size(), out);
+    detail::write_varint(block.size(), out);
+    out.append(block);
+  }
+  return out;
+}
+
+/// Returns nullopt if `data` is not the output of `compress`.
+inline auto decompress(std::string_view data) -> std::optional<std::string> {
+  std::string out;
+  std::size_t pos = 0;
+  while (pos < data.size()) {
+    const auto size = detail::read_varint(data, pos);
+    const auto compressed = detail::read_varint(data, pos);
+    if (!size || !compressed || *size > BLOCK_SIZE || *compressed > data.size() - pos) {
+      return std::nullopt;
+    }
+    out.reserve(out.size() + *size);
+    if (!detail::decompress_block(data.substr(pos, *compressed), *size, out)) return std::nullopt;
+    pos += *compressed;
+  }
+  return out;
+}
+}  // namespace cplib_initializers::common::compress
+
+#endif
@@ -0,0 +1,284 @@
+/*
+ * This file is part of CPLibInitializers.
+ *
+ * CPLibInitializers is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * CPLibInitializers is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with
+ * CPLibInitializers. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file coroutine.hpp
+ *
+ * Single-threaded coroutine runtime for interactors.
+ *
+ * An interactor written as a `Task<>` awaits contestant input instead of blocking on it, so other
+ * tasks (background precomputation, or conversations with other contestant channels) run in the
+ * meantime:
+ *
+ *     auto interactor_task() -> Task<> {
+ *       interactor.to_user << "? 1\n";
+ *       auto answer = co_await read(interactor.from_user, cplib::var::i32("answer"));
+ *       ...
+ *     }
+ *
+ *     auto interactor_main() -> void { run(interactor_task()); }
+ *
+ * Input is awaited line by line: a read resumes once a complete line is buffered, and then parses
+ * it with the ordinary reader, so tokens must not span lines. Readers that were not set up by
+ * common/channel.hpp fall back to blocking reads. Blocking-style interactors are unaffected.
+ */
+
+#ifndef CPLIB_INITIALIZERS_COMMON_COROUTINE_HPP_
+#define CPLIB_INITIALIZERS_COMMON_COROUTINE_HPP_
+
+#include <poll.h>
+
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "channel.hpp"
+#include "cplib.hpp"
+
+namespace cplib_initializers::common::coroutine {
+
+template <class T = void>
+class Task;
+
+class Runtime;
+
+namespace detail {
+inline thread_local Runtime *current_runtime = nullptr;
+
+struct FinalAwaiter {
+  [[nodiscard]] auto await_ready() const noexcept -> bool { return false; }
+
+  template <class Promise>
+  auto await_suspend(std::coroutine_handle<Promise> handle) noexcept -> std::coroutine_handle<> {
+    if (auto continuation = handle.promise().continuation) return continuation;
+    return std::noop_coroutine();
+  }
+
+  auto await_resume() const noexcept -> void {}
+};
+
+struct PromiseBase {
+  std::coroutine_handle<> continuation;
+  std::exception_ptr exception;
+
+  auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+  auto final_suspend() noexcept -> FinalAwaiter { return {}; }
+  auto unhandled_exception() noexcept -> void { exception = std::current_exception(); }
+};
+
+template <class T>
+struct Promise : PromiseBase {
+  std::optional<T> value;
+
+  auto get_return_object() -> Task<T>;
+  auto return_value(T result) -> void { value.emplace(std::move(result)); }
+
+  auto result() -> T {
+    if (exception) std::rethrow_exception(exception);
+    return std::move(*value);
+  }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+  auto get_return_object() -> Task<void>;
+  auto return_void() -> void {}
+
+  auto result() -> void {
+    if (exception) std::rethrow_exception(exception);
+  }
+};
+}  // namespace detail
+
+/**
+ * A lazily started coroutine. Awaiting it runs it to completion and yields its result; exceptions
+ * propagate to the awaiter.
+ */
+template <class T>
+class [[nodiscard]] Task {
+ public:
+  using promise_type = detail::Promise<T>;
+
+  explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+  Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+  auto operator=(Task &&other) noexcept -> Task & {
+    std::swap(handle_, other.handle_);
+    return *this;
+  }
+
+  Task(const Task &) = delete;
+  auto operator=(const Task &) -> Task & = delete;
+
+  ~Task() {
+    if (handle_) handle_.destroy();
+  }
+
+  [[nodiscard]] auto handle() const -> std::coroutine_handle<promise_type> { return handle_; }
+
+  [[nodiscard]] auto await_ready() const noexcept -> bool { return false; }
+
+  auto await_suspend(std::coroutine_handle<> continuation) noexcept -> std::coroutine_handle<> {
+    handle_.promise().continuation = continuation;
+    return handle_;
+  }
+
+  auto await_resume() -> T { return handle_.promise().result(); }
+
+ private:
+  std::coroutine_handle<promise_type> handle_;
+};
+
+template <class T>
+auto detail::Promise<T>::get_return_object() -> Task<T> {
+  return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline auto detail::Promise<void>::get_return_object() -> Task<void> {
+  return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+/**
+ * Runs tasks on the calling thread. Ready tasks run in FIFO order; when none is ready the runtime
+ * sleeps in `poll` until a channel some task is waiting on has input.
+ */
+class Runtime {
+ public:
+  Runtime() = default;
+  Runtime(const Runtime &) = delete;
+  auto operator=(const Runtime &) -> Runtime & = delete;
+
+  // Start `task` alongside the others; the runtime owns it until `run` returns.
+  auto spawn(Task<> task) -> void {
+    ready_.push_back(task.handle());
+    tasks_.push_back(std::move(task));
+  }
+
+  // Run until every task has finished. Rethrows the first exception escaping a spawned task.
+  auto run() -> void {
+    auto *previous = std::exchange(detail::current_runtime, this);
+    while (true) {
+      if (!waiting_.empty()) wake_readable(ready_.empty() ? -1 : 0);
+      if (ready_.empty()) break;
+      auto handle = ready_.front();
+      ready_.pop_front();
+      handle.resume();
+    }
+    detail::current_runtime = previous;
+
+    for (auto &task : tasks_) {
+      if (task.handle().done()) task.handle().promise().result();
+    }
+  }
+
+  auto schedule(std::coroutine_handle<> handle) -> void { ready_.push_back(handle); }
+
+  // Resume `handle` once `buf` has a complete line.
+  auto wait_line(channel::FromUserBuf *buf, std::coroutine_handle<> handle) -> void {
+    buf->flush_to_user();
+    waiting_.push_back({buf, handle});
+  }
+
+ private:
+  struct Waiter {
+    channel::FromUserBuf *buf;
+    std::coroutine_handle<> handle;
+  };
+
+  auto wake_readable(int timeout) -> void {
+    std::vector<pollfd> entries;
+    entries.reserve(waiting_.size());
+    while (true) {
+      std::erase_if(waiting_, [this](const Waiter &waiter) {
+        if (!waiter.buf->line_ready()) return false;
+        ready_.push_back(waiter.handle);
+        return true;
+      });
+      if (!ready_.empty() || waiting_.empty() || timeout == 0) return;
+
+      entries.clear();
+      for (const auto &waiter : waiting_) entries.push_back({waiter.buf->fd(), POLLIN, 0});
+      if (poll(entries.data(), entries.size(), timeout) < 0 && errno != EINTR) {
+        cplib::panic("coroutine::Runtime: poll failed");
+      }
+    }
+  }
+
+  std::deque<std::coroutine_handle<>> ready_;
+  std::vector<Waiter> waiting_;
+  std::vector<Task<>> tasks_;
+};
+
+// Run `task`, and everything it spawns, to completion on a new runtime.
+inline auto run(Task<> task) -> void {
+  Runtime runtime;
+  runtime.spawn(std::move(task));
+  runtime.run();
+}
+
+// Start `task` on the current runtime without awaiting it.
+inline auto spawn(Task<> task) -> void {
+  if (detail::current_runtime == nullptr) cplib::panic("coroutine::spawn: no runtime is running");
+  detail::current_runtime->spawn(std::move(task));
+}
+
+// Awaitable that lets other ready tasks run, for long computations in the background.
+struct Yield {
+  [[nodiscard]] auto await_ready() const noexcept -> bool {
+    return detail::current_runtime == nullptr;
+  }
+  auto await_suspend(std::coroutine_handle<> handle) const -> void {
+    detail::current_runtime->schedule(handle);
+  }
+  auto await_resume() const noexcept -> void {}
+};
+
+inline auto yield() -> Yield { return {}; }
+
+// Awaitable that completes once a complete line can be read from a contestant channel.
+struct LineReady {
+  channel::FromUserBuf *buf;
+
+  [[nodiscard]] auto await_ready() const -> bool {
+    return buf == nullptr || detail::current_runtime == nullptr || buf->line_ready();
+  }
+  auto await_suspend(std::coroutine_handle<> handle) const -> void {
+    detail::current_runtime->wait_line(buf, handle);
+  }
+  auto await_resume() const noexcept -> void {}
+};
+
+inline auto line_ready(channel::FromUserBuf &buf) -> LineReady { return {&buf}; }
+
+inline auto line_ready(const cplib::var::Reader &reader) -> LineReady {
+  return {channel::from_user_buf(reader)};
+}
+
+// Await a line from `reader`, then read `var` from it.
+template <class Var>
+auto read(cplib::var::Reader &reader, Var var)
+    -> Task<decltype(std::declval<cplib::var::Reader &>().read(std::declval<Var>()))> {
+  co_await line_ready(reader);
+  co_return reader.read(std::move(var));
+}
+}  // namespace cplib_initializers::common::coroutine
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * This file is part of CPLibInitializers.
+ *
+ * CPLibInitializers is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * CPLibInitializers is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with
+ * CPLibInitializers. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file crc32c.hpp
+ *
+ * CRC-32C (Castagnoli), using the SSE4.2 `crc32` instruction where the CPU has it.
+ */
+
+#ifndef CPLIB_INITIALIZERS_COMMON_CRC32C_HPP_
+#define CPLIB_INITIALIZERS_COMMON_CRC32C_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define CPLIB_INITIALIZERS_CRC32C_X86 1
+#endif
+
+namespace cplib_initializers::common::crc32c {
+
+namespace detail {
+constexpr std::uint32_t POLYNOMIAL = 0x82f63b78;  // Reflected.
+
+constexpr auto make_table() -> std::array<std::uint32_t, 256> {
+  std::array<std::uint32_t, 256> table{};
+  for (std::uint32_t i = 0; i < 256; ++i) {
+    auto crc = i;
+    for (int bit = 0; bit < 8; ++bit) crc = (crc >> 1) ^ ((crc & 1) != 0 ? POLYNOMIAL : 0);
+    table[i] = crc;
+  }
+  return table;
+}
+
+constexpr auto TABLE = make_table();
+
+inline auto update_scalar(std::uint32_t crc, const unsigned char *data, std::size_t size)
+    -> std::uint32_t {
+  for (std::size_t i = 0; i < size; ++i) crc = (crc >> 8) ^ TABLE[(crc ^ data[i]) & 0xff];
+  return crc;
+}
+
+#ifdef CPLIB_INITIALIZERS_CRC32C_X86
+__attribute__((target("sse4.2"))) inline auto update_sse42(std::uint32_t crc,
+                                                           const unsigned char *data,
+                                                           std::size_t size) -> std::uint32_t {
+  std::uint64_t wide = crc;
+  for (; size >= 8; data += 8, size -= 8) {
+    std::uint64_t word = 0;
+    std::memcpy(&word, data, sizeof(word));
+    wide = _mm_crc32_u64(wide, word);
+  }
+  crc = static_cast<std::uint32_t>(wide);
+  for (; size > 0; ++data, --size) crc = _mm_crc32_u8(crc, *data);
+  return crc;
+}
+#endif
+}  // namespace detail
+
+inline auto compute(std::string_view data) -> std::uint32_t {
+  const auto *bytes = reinterpret_cast<const unsigned char *>(data.data());
+#ifdef CPLIB_INITIALIZERS_CRC32C_X86
+  static const bool hardware = __builtin_cpu_supports("sse4.2");
+  if (hardware) return ~detail::update_sse42(~0U, bytes, data.size());
+#endif
+  return ~detail::update_scalar(~0U, bytes, data.size());
+}
+}  // namespace cplib_initializers::common::crc32c
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ * This file is part of CPLibInitializers.
+ *
+ * CPLibInitializers is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * CPLibInitializers is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with
+ * CPLibInitializers. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file interactor.hpp
+ *
+ * Base of the interactor initializers.
+ *
+ * On top of the profile of profile.hpp, which also counts what is read from `from_user`, it
+ * connects `from_user` and `to_user` to the contestant. By default these are cplib's own streams.
+ * Constructing the initializer with `channel::Options`, or setting one of the channel's
+ * environment variables (see `channel::requested_by_env`), installs the contestant channel of
+ * channel.hpp instead, which brings tracing, transcripts, the warm server and CPU placement.
+ */
+
+#ifndef CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_
+#define CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_
+
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "channel.hpp"
+#include "cplib.hpp"
+#include "profile.hpp"
+
+namespace cplib_initializers::common::interactor {
+
+struct Initializer : profile::Profiled<cplib::interactor::Initializer> {
+  // Options of the contestant channel, or nullopt for cplib's own streams.
+  std::optional<channel::Options> channel_options;
+  // The installed channel's `to_user`, null while cplib's own streams are used.
+  std::unique_ptr<channel::ToUserBuf> to_user_buf;
+
+  Initializer() = default;
+
+  explicit Initializer(channel::Options channel_options)
+      : channel_options(std::move(channel_options)) {}
+
+ protected:
+  // Let the channel serve warm sessions, see server.hpp. Only for reporters that write to stderr,
+  // which each session passes on its own; any other report target would be shared by all sessions,
+  // so server mode is refused otherwise. Must be called before `set_user_fileno`.
+  auto allow_sessions() -> void { sessions_allowed_ = true; }
+
+  // Whether `set_user_fileno` installs the contestant channel.
+  [[nodiscard]] auto uses_channel() const -> bool {
+    return channel_options.has_value() || channel::requested_by_env();
+  }
+
+  // Read `from_user` from `from_user_fd` and write `to_user` to `to_user_fd`.
+  auto set_user_fileno(int from_user_fd, int to_user_fd, cplib::trace::Level trace_level)
+      -> void {
+    if (!uses_channel()) {
+      if (profile::detail::enabled()) {
+        install(Profiled::state().from_user, profile::Stream::FROM_USER, from_user_fd, false,
+                trace_level);
+      } else {
+        set_from_user_fileno(from_user_fd, trace_level);
+      }
+      set_to_user_fileno(to_user_fd);
+      return;
+    }
+
+    if (!channel_options.has_value()) channel_options.emplace();
+    if (!sessions_allowed_ &&
+        !channel::resolve_options(*channel_options).server.socket_path.empty()) {
+      cplib::panic("server: this platform does not report on stderr, so it cannot serve sessions");
+    }
+    to_user_buf = channel::install(Profiled::state(), from_user_fd, to_user_fd, trace_level,
+                                   *channel_options);
+  }
+
+ private:
+  bool sessions_allowed_ = false;
+};
+}  // namespace cplib_initializers::common::interactor
+
+#endif
@@ -0,0 +1,253 @@
+/*
+ * This file is part of CPLibInitializers.
+ *
+ * CPLibInitializers is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * CPLibInitializers is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with
+ * CPLibInitializers. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file placement.hpp
+ *
+ * CPU placement and scheduling policy of the interactor process.
+ *
+ * Round-trip latency between interactor and contestant depends on whether the two share a core or
+ * a cache, so pinning the interactor next to the contestant makes it both lower and more stable.
+ * All settings are best effort: a sandbox that forbids them leaves the process as it was.
+ */
+
+#ifndef CPLIB_INITIALIZERS_COMMON_PLACEMENT_HPP_
+#define CPLIB_INITIALIZERS_COMMON_PLACEMENT_HPP_
+
+#include <sched.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace cplib_initializers::common::placement {
+
+// CPU the contestant runs on, if the judge pins it.
+constexpr std::string_view CONTESTANT_CPU_ENV = "CPLIB_INITIALIZERS_CONTESTANT_CPU";
+// Process ID of the contestant, if the judge knows it.
+constexpr std::string_view CONTESTANT_PID_ENV = "CPLIB_INITIALIZERS_CONTESTANT_PID";
+
+struct Options {
+  // Pin the interactor to this CPU.
+  std::optional<int> cpu{};
+  // Pin the interactor to a hardware thread sibling of the contestant's CPU, or to that CPU itself
+  // if it has none. Ignored when `cpu` is set. The contestant's CPU is taken from
+  // `CONTESTANT_CPU_ENV`, or read from `/proc` for the process given by `CONTESTANT_PID_ENV` or
+  // found at the other end of `from_user`.
+  bool near_contestant = false;
+  // Scheduling policy (such as `SCHED_FIFO` or `SCHED_BATCH`) and its static priority.
+  std::optional<int> sched_policy{};
+  int sched_priority = 0;
+};
+
+namespace detail {
+inline auto parse_int(std::string_view text) -> std::optional<int> {
+  int value;
+  const auto *end = text.data() + text.size();
+  auto [ptr, ec] = std::from_chars(text.data(), end, value);
+  if (ec != std::errc() || ptr != end) return std::nullopt;
+  return value;
+}
+
+inline auto env_int(std::string_view name) -> std::optional<int> {
+  const auto *value = std::getenv(name.data());
+  return value != nullptr ? parse_int(value) : std::nullopt;
+}
+
+// Another process holding the pipe or FIFO `fd` refers to, other than this one and its parent.
+inline auto peer_pid(int fd) -> std::optional<int> {
+  struct stat target{};
+  if (fstat(fd, &target) != 0) return std::nullopt;
+
+  const auto self = getpid();
+  const auto parent = getppid();
+  std::error_code ec;
+  for (const auto &process : std::filesystem::directory_iterator("/proc", ec)) {
+    const auto pid = parse_int(process.path().filename().string());
+    if (!pid.has_value() || *pid == self || *pid == parent) continue;
+    for (const auto &entry : std::filesystem::directory_iterator(process.path() / "fd", ec)) {
+      struct stat info{};
+      if (stat(entry.path().c_str(), &info) == 0 && info.st_dev == target.st_dev &&
+          info.st_ino == target.st_ino) {
+        return pid;
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+// The CPU a process last ran on, field 39 of `/proc/<pid>/stat`.
+inline auto last_cpu(int pid) -> std::optional<int> {
+  std::ifstream file("/proc/" + std::to_string(pid) + "/stat");
+  std::string stat;
+  if (!std::getline(file, stat)) return std::nullopt;
+  // The command name may contain spaces, fields are counted from the closing parenthesis.
+  const auto comm_end = stat.rfind(')');
+  if (comm_end == std::string::npos) return std::nullopt;
+  std::istringstream fields(stat.substr(comm_end + 1));
+  std::string field;
+  for (int i = 3; i <= 39; ++i) {
+    if (!(fields >> field)) return std::nullopt;
+  }
+  return parse_int(field);
+}
+
+// The contestant given by `CONTESTANT_PID_ENV`, or the process at the other end of `from_user`.
+inline auto contestant_pid(int from_user_fd) -> std::optional<int> {
+  if (auto pid = env_int(CONTESTANT_PID_ENV)) return pid;
+  return peer_pid(from_user_fd);
+}
+
+inline auto contestant_cpu(int from_user_fd) -> std::optional<int> {
+  if (auto cpu = env_int(CONTESTANT_CPU_ENV)) return cpu;
+  const auto pid = contestant_pid(from_user_fd);
+  return pid.has_value() ? last_cpu(*pid) : std::nullopt;
+}
+
+// The first line of a file under `/proc`, or empty if it cannot be read.
+inline auto proc_line(const std::filesystem::path &path) -> std::string {
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+// Whether a sleeping thread waits for input: it is in a read or poll system call, or, where
+// `syscall` is not readable, its wait channel is a read.
+inline auto waits_for_input(const std::filesystem::path &task) -> bool {
+  const auto syscall = proc_line(task / "syscall");
+  if (const auto number = parse_int(syscall.substr(0, syscall.find(' ')))) {
+    switch (*number) {
+      case SYS_read:
+      case SYS_readv:
+      case SYS_pread64:
+      case SYS_preadv:
+      case SYS_ppoll:
+      case SYS_pselect6:
+      case SYS_epoll_pwait:
+#ifdef SYS_poll
+      case SYS_poll:
+#endif
+#ifdef SYS_select
+      case SYS_select:
+#endif
+#ifdef SYS_epoll_wait
+      case SYS_epoll_wait:
+#endif
+        return true;
+      default:
+        return false;
+    }
+  }
+  const auto wchan = proc_line(task / "wchan");
+  return wchan.find("read") != std::string::npos || wchan == "pipe_wait";
+}
+
+/**
+ * Whether process `pid` is blocked waiting for input: none of its threads is running and one of
+ * them is in a read. False if `/proc` does not tell, e.g. when the process is hidden or gone.
+ */
+inline auto blocked_on_read(int pid) -> bool {
+  std::error_code ec;
+  bool waiting = false;
+  for (const auto &task :
+       std::filesystem::directory_iterator("/proc/" + std::to_string(pid) + "/task", ec)) {
+    const auto stat = proc_line(task.path() / "stat");
+    // The command name may contain spaces, the state follows the closing parenthesis.
+    const auto comm_end = stat.rfind(')');
+    if (comm_end == std::string::npos || comm_end + 2 >= stat.size()) return false;
+    switch (stat[comm_end + 2]) {
+      case 'R':
+      case 'D':
+        return false;
+      case 'S':
+        waiting = waiting || waits_for_input(task.path());
+        break;
+      default:
+        break;
+    }
+  }
+  return waiting;
+}
+
+// CPUs in a list like `0-1,8`.
+inline auto parse_cpu_list(std::string_view list) -> std::vector<int> {
+  std::vector<int> cpus;
+  while (!list.empty()) {
+    const auto comma = list.find(',');
+    const auto range = list.substr(0, comma);
+    list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+    const auto dash = range.find('-');
+    const auto first = parse_int(range.substr(0, dash));
+    const auto last = dash == std::string_view::npos ? first : parse_int(range.substr(dash + 1));
+    if (!first.has_value() || !last.has_value()) return {};
+    for (auto cpu = *first; cpu <= *last; ++cpu) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+// A hardware thread sharing a core with `cpu`, or `cpu` itself.
+inline auto sibling_of(int cpu) -> int {
+  std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                     "/topology/thread_siblings_list");
+  std::string list;
+  if (!std::getline(file, list)) return cpu;
+  for (auto sibling : parse_cpu_list(list)) {
+    if (sibling != cpu) return sibling;
+  }
+  return cpu;
+}
+
+inline auto pin_to(int cpu) -> bool {
+  if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+}  // namespace detail
+
+/**
+ * Apply `options` to the calling process. `from_user_fd` is used to find the contestant when
+ * placing the interactor next to it. Returns false if any requested setting could not be applied.
+ */
+inline auto apply(const Options &options, int from_user_fd) -> bool {
+  bool ok = true;
+  if (options.cpu.has_value()) {
+    ok = detail::pin_to(*options.cpu);
+  } else if (options.near_contestant) {
+    const auto cpu = detail::contestant_cpu(from_user_fd);
+    ok = cpu.has_value() && detail::pin_to(detail::sibling_of(*cpu));
+  }
+  if (options.sched_policy.has_value()) {
+    sched_param param{};
+    param.sched_priority = options.sched_priority;
+    ok = sched_setscheduler(0, *options.sched_policy, &param) == 0 && ok;
+  }
+  return ok;
+}
+}  // namespace cplib_initializers::common::placement
+
+#endif
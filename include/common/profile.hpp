@@ -0,0 +1,601 @@
+/*
+ * This file is part of CPLibInitializers.
+ *
+ * CPLibInitializers is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * CPLibInitializers is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with
+ * CPLibInitializers. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file profile.hpp
+ *
+ * Opt-in per-phase timing profile of a checker or interactor run.
+ *
+ * When `CPLIB_INITIALIZERS_PROFILE` names a file, `/dev/fd/<n>` for an inherited descriptor, the
+ * initializer's streams are read through a counting buffer and the run is split into phases on a
+ * monotonic clock. After the report, one JSON line is appended to that file, also when the run
+ * ends during `init`, e.g. on invalid arguments:
+ *
+ *     {"version":1,"mode":"checker","exit_code":0,"phases_ns":{...},"streams":{...},
+ *      "counters":{...}}
+ *
+ * `phases_ns` holds the duration of each phase, or `null` if the run did not reach it:
+ *
+ * - `exec`: from the process start to the static initialization of this header. The start time is
+ *   only known in clock ticks, usually 10 ms.
+ * - `static_init`: until the initializer's `init` starts.
+ * - `args`: argument parsing and anything else before the first stream is opened.
+ * - `open`: from opening the first stream to opening the last one.
+ * - `read`: from the first read of `inf`, `ouf` or `ans` to the last refill of any of them.
+ * - `evaluate`: from there to the report, which for an interactor covers the whole interaction,
+ *   including its reads of `from_user`.
+ * - `report`: rendering the report, including files the reporter writes itself.
+ * - `report_io`: flushing standard output and error afterwards.
+ *
+ * `streams` holds, for each of `inf`, `ouf`, `ans` and an interactor's `from_user` the initializer
+ * opened, the bytes read and when the stream was first and last read, in nanoseconds since the
+ * static initialization.
+ *
+ * `counters` holds the cycles, instructions, cache misses and branch misses of the `read` and
+ * `evaluate` phases, counted in user space with `perf_event_open`. A counter is `null` where the
+ * CPU or the sandbox does not provide it (see `perf_event_paranoid`), and a phase is `null` if
+ * none is.
+ *
+ * An initializer takes part by deriving from `Profiled<cplib::checker::Initializer>` (or the
+ * interactor one), which hides the stream setters and `state()`, and setting its reporter with
+ * `set_reporter`; with the variable unset they behave exactly like the base class.
+ */
+
+#ifndef CPLIB_INITIALIZERS_COMMON_PROFILE_HPP_
+#define CPLIB_INITIALIZERS_COMMON_PROFILE_HPP_
+
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "cplib.hpp"
+
+namespace cplib_initializers::common::profile {
+
+constexpr std::string_view PATH_ENV = "CPLIB_INITIALIZERS_PROFILE";
+
+enum struct Stream : std::uint8_t { INF, OUF, ANS, FROM_USER };
+
+constexpr std::array<std::string_view, 4> STREAM_NAMES{"inf", "ouf", "ans", "from_user"};
+
+constexpr std::array<std::string_view, 4> COUNTER_NAMES{"cycles", "instructions", "cache_misses",
+                                                       "branch_misses"};
+
+// Hardware counters of one phase, in the order of `COUNTER_NAMES`; nullopt for those the CPU or
+// the sandbox does not provide.
+using Counters = std::array<std::optional<std::uint64_t>, 4>;
+
+struct StreamRecord {
+  bool opened = false;
+  std::uint64_t bytes = 0;
+  std::optional<std::uint64_t> first_read_ns;
+  std::optional<std::uint64_t> last_read_ns;
+};
+
+// Points in time of one run, in nanoseconds since the static initialization.
+struct Record {
+  std::string_view mode;
+  std::optional<std::uint64_t> exec_ns;
+  std::optional<std::uint64_t> init_ns;
+  std::optional<std::uint64_t> first_open_ns;
+  std::optional<std::uint64_t> opened_ns;
+  std::optional<std::uint64_t> report_ns;
+  std::optional<std::uint64_t> reported_ns;
+  std::optional<std::uint64_t> flushed_ns;
+  std::array<StreamRecord, 4> streams{};
+  // Nullopt if no counter could be opened.
+  std::optional<Counters> read_counters;
+  std::optional<Counters> evaluate_counters;
+  int exit_code = 0;
+};
+
+namespace detail {
+inline const auto EPOCH = std::chrono::steady_clock::now();
+
+inline auto now_ns() -> std::uint64_t {
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - EPOCH)
+          .count());
+}
+
+// Age of the process from field 22 of `/proc/self/stat`, in clock ticks since boot.
+inline auto process_age_ns() -> std::optional<std::uint64_t> {
+  std::ifstream stat("/proc/self/stat");
+  std::string line;
+  timespec boot{};
+  if (!std::getline(stat, line) || clock_gettime(CLOCK_BOOTTIME, &boot) != 0) return std::nullopt;
+  const auto comm_end = line.rfind(')');
+  if (comm_end == std::string::npos) return std::nullopt;
+  std::istringstream fields(line.substr(comm_end + 1));
+  std::string field;
+  for (int i = 3; i <= 22 && fields >> field; ++i) {
+  }
+  const auto ticks_per_second = sysconf(_SC_CLK_TCK);
+  if (!fields || ticks_per_second <= 0) return std::nullopt;
+  const auto start_ns = std::stoull(field) * (1'000'000'000ULL / ticks_per_second);
+  const auto boot_ns = static_cast<std::uint64_t>(boot.tv_sec) * 1'000'000'000ULL +
+                       static_cast<std::uint64_t>(boot.tv_nsec);
+  return boot_ns > start_ns ? boot_ns - start_ns : 0;
+}
+
+inline auto enabled() -> bool {
+  static const bool enabled = [] {
+    const auto *path = std::getenv(PATH_ENV.data());
+    return path != nullptr && *path != '\0';
+  }();
+  return enabled;
+}
+
+inline const auto EXEC_NS = enabled() ? process_age_ns() : std::nullopt;
+
+inline Record record;
+
+inline auto span(std::optional<std::uint64_t> from, std::optional<std::uint64_t> to)
+    -> std::optional<std::uint64_t> {
+  if (!from || !to) return std::nullopt;
+  return *to > *from ? *to - *from : 0;
+}
+
+inline auto json(std::optional<std::uint64_t> value) -> std::string {
+  return value ? std::to_string(*value) : "null";
+}
+
+inline auto json(const std::optional<Counters> &counters) -> std::string {
+  if (!counters) return "null";
+  std::string out = "{";
+  for (std::size_t i = 0; i < counters->size(); ++i) {
+    out += std::format(R"({}"{}":{})", i == 0 ? "" : ",", COUNTER_NAMES[i], json((*counters)[i]));
+  }
+  return out + "}";
+}
+
+inline auto difference(const Counters &from, const Counters &to) -> Counters {
+  Counters result;
+  for (std::size_t i = 0; i < result.size(); ++i) {
+    if (from[i] && to[i]) result[i] = *to[i] > *from[i] ? *to[i] - *from[i] : 0;
+  }
+  return result;
+}
+
+/**
+ * The events of `COUNTER_NAMES` in one `perf_event_open` group, counting this thread in user space.
+ * Events that fail to open are left out, and with none at all, `read` returns nullopt.
+ */
+class PerfGroup {
+ public:
+  PerfGroup() {
+    constexpr std::array<std::uint64_t, 4> CONFIGS{
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES};
+    for (std::size_t i = 0; i < CONFIGS.size(); ++i) {
+      perf_event_attr attr{};
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = CONFIGS[i];
+      attr.disabled = leader_ < 0 ? 1 : 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format =
+          PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      const auto fd = static_cast<int>(
+          syscall(SYS_perf_event_open, &attr, 0, -1, leader_, PERF_FLAG_FD_CLOEXEC));
+      if (fd < 0) continue;
+      if (leader_ < 0) leader_ = fd;
+      fds_[i] = fd;
+      slots_[i] = opened_++;
+    }
+    if (leader_ >= 0) ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  PerfGroup(const PerfGroup &) = delete;
+  auto operator=(const PerfGroup &) -> PerfGroup & = delete;
+
+  ~PerfGroup() {
+    for (const auto fd : fds_) {
+      if (fd >= 0) close(fd);
+    }
+  }
+
+  // Counts since the group was opened, scaled up if the kernel had to multiplex the group.
+  auto read() const -> std::optional<Counters> {
+    if (leader_ < 0) return std::nullopt;
+    // nr, time_enabled, time_running, then one value per event.
+    std::array<std::uint64_t, 3 + 4> buffer{};
+    if (::read(leader_, buffer.data(), sizeof(buffer)) < static_cast<ssize_t>(3 * 8)) {
+      return std::nullopt;
+    }
+    const auto enabled = buffer[1], running = buffer[2];
+    Counters counters;
+    for (std::size_t i = 0; i < counters.size(); ++i) {
+      if (slots_[i] < 0 || running == 0) continue;
+      const auto value = buffer[3 + slots_[i]];
+      counters[i] = enabled == running
+                        ? value
+                        : static_cast<std::uint64_t>(static_cast<double>(value) *
+                                                     static_cast<double>(enabled) /
+                                                     static_cast<double>(running));
+    }
+    return counters;
+  }
+
+ private:
+  int leader_ = -1;
+  int opened_ = 0;
+  std::array<int, 4> fds_{-1, -1, -1, -1};
+  std::array<int, 4> slots_{-1, -1, -1, -1};
+};
+
+// Opened by the first read of `inf`, `ouf` or `ans`, which starts the read phase.
+inline std::unique_ptr<PerfGroup> perf;
+inline std::optional<Counters> counters_at_last_read;
+
+// Called before a profiled stream is refilled. The first read of `inf`, `ouf` or `ans` starts the
+// read phase and its counters. Returns when the read starts.
+inline auto begin_read(Stream stream) -> std::uint64_t {
+  if (enabled() && stream != Stream::FROM_USER && !perf) perf = std::make_unique<PerfGroup>();
+  return now_ns();
+}
+
+// Called after a read of `stream` that started at `start_ns` and returned `size`.
+inline auto end_read(Stream stream, std::uint64_t start_ns, ssize_t size) -> void {
+  auto &target = record.streams[static_cast<std::size_t>(stream)];
+  target.opened = true;
+  if (!target.first_read_ns) target.first_read_ns = start_ns;
+  target.last_read_ns = now_ns();
+  if (size > 0) target.bytes += static_cast<std::uint64_t>(size);
+  if (stream != Stream::FROM_USER && perf) counters_at_last_read = perf->read();
+}
+}  // namespace detail
+
+/**
+ * Count a read of `size` bytes from the contestant through a buffer other than the one `Profiled`
+ * installs, such as the channel of channel.hpp.
+ */
+inline auto count_from_user(ssize_t size) -> void {
+  if (detail::enabled()) detail::end_read(Stream::FROM_USER, detail::now_ns(), size);
+}
+
+inline auto to_json(const Record &record) -> std::string {
+  std::optional<std::uint64_t> first_read, last_read;
+  // Reading `from_user` is part of the interaction, not of the read phase.
+  for (const auto index : {Stream::INF, Stream::OUF, Stream::ANS}) {
+    const auto &stream = record.streams[static_cast<std::size_t>(index)];
+    if (stream.first_read_ns) {
+      first_read = std::min(first_read.value_or(*stream.first_read_ns), *stream.first_read_ns);
+    }
+    if (stream.last_read_ns) {
+      last_read = std::max(last_read.value_or(*stream.last_read_ns), *stream.last_read_ns);
+    }
+  }
+  const auto opened = record.opened_ns ? record.opened_ns : record.init_ns;
+  const std::array<std::pair<std::string_view, std::optional<std::uint64_t>>, 8> phases{{
+      {"exec", record.exec_ns},
+      {"static_init", record.init_ns},
+      {"args", detail::span(record.init_ns, record.first_open_ns)},
+      {"open", detail::span(record.first_open_ns, record.opened_ns)},
+      {"read", detail::span(first_read, last_read)},
+      {"evaluate", detail::span(last_read ? last_read : opened, record.report_ns)},
+      {"report", detail::span(record.report_ns, record.reported_ns)},
+      {"report_io", detail::span(record.reported_ns, record.flushed_ns)},
+  }};
+
+  std::string out = std::format(R"({{"version":1,"mode":"{}","exit_code":{},"phases_ns":{{)",
+                                record.mode, record.exit_code);
+  for (std::size_t i = 0; i < phases.size(); ++i) {
+    out += std::format(R"({}"{}":{})", i == 0 ? "" : ",", phases[i].first,
+                       detail::json(phases[i].second));
+  }
+  out += R"(},"streams":{)";
+  std::string_view separator;
+  for (std::size_t i = 0; i < record.streams.size(); ++i) {
+    const auto &stream = record.streams[i];
+    if (!stream.opened) continue;
+    out += std::format(R"({}"{}":{{"bytes":{},"first_read_ns":{},"last_read_ns":{}}})", separator,
+                       STREAM_NAMES[i], stream.bytes, detail::json(stream.first_read_ns),
+                       detail::json(stream.last_read_ns));
+    separator = ",";
+  }
+  out += std::format(R"(}},"counters":{{"read":{},"evaluate":{}}}}})",
+                     detail::json(record.read_counters), detail::json(record.evaluate_counters));
+  out += "\n";
+  return out;
+}
+
+namespace detail {
+// Append the record as one `write`, so that concurrent runs may share a file.
+inline auto write_record(const Record &record) -> void {
+  const auto line = to_json(record);
+  const auto fd = open(std::getenv(PATH_ENV.data()), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                       0644);
+  if (fd < 0) return;
+  std::string_view rest = line;
+  while (!rest.empty()) {
+    const auto written = write(fd, rest.data(), rest.size());
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) break;
+    rest.remove_prefix(static_cast<std::size_t>(written));
+  }
+  close(fd);
+}
+
+/**
+ * Reads `fd` for a profiled stream, counting bytes and noting when the buffer is refilled.
+ *
+ * With a `limit`, `exceeded` (which must not return) is called once the stream turns out to be
+ * larger: a regular file before its first byte is read, anything else as soon as more arrived.
+ */
+class CountingBuf : public std::streambuf {
+ public:
+  CountingBuf(int fd, bool owned, Stream stream, std::uint64_t limit = 0,
+              std::function<void()> exceeded = {})
+      : fd_(fd), owned_(owned), stream_(stream), limit_(limit), exceeded_(std::move(exceeded)) {}
+
+  CountingBuf(const CountingBuf &) = delete;
+  auto operator=(const CountingBuf &) -> CountingBuf & = delete;
+
+  ~CountingBuf() override {
+    if (owned_) close(fd_);
+  }
+
+ protected:
+  auto underflow() -> int_type override {
+    if (gptr() == egptr()) {
+      const auto start_ns = begin_read(stream_);
+      if (limit_ != 0 && received_ == 0) check_file_size();
+      ssize_t size;
+      while ((size = read(fd_, buffer_.data(), buffer_.size())) < 0 && errno == EINTR) {
+      }
+      end_read(stream_, start_ns, size);
+      if (size <= 0) return traits_type::eof();
+      received_ += static_cast<std::uint64_t>(size);
+      if (limit_ != 0 && received_ > limit_) exceeded_();
+      setg(buffer_.data(), buffer_.data(), buffer_.data() + size);
+    }
+    return traits_type::to_int_type(*gptr());
+  }
+
+ private:
+  auto check_file_size() -> void {
+    struct stat info{};
+    if (fstat(fd_, &info) == 0 && S_ISREG(info.st_mode) &&
+        static_cast<std::uint64_t>(info.st_size) > limit_) {
+      exceeded_();
+    }
+  }
+
+  int fd_;
+  bool owned_;
+  Stream stream_;
+  std::uint64_t limit_;
+  std::uint64_t received_ = 0;
+  std::function<void()> exceeded_;
+  std::array<char, 1 << 16> buffer_;
+};
+
+// Moves the trace stacks attached to `from` to `to`; they are protected members of the base.
+template <class Reporter, class Member>
+auto move_stacks(Reporter &from, Reporter &to, Member member) -> void {
+  auto &source = from.*member;
+  auto &target = to.*member;
+  target.insert(target.end(), std::make_move_iterator(source.begin()),
+                std::make_move_iterator(source.end()));
+  source.clear();
+}
+
+struct CheckerStacks : cplib::checker::Reporter {
+  static auto move(cplib::checker::Reporter &from, cplib::checker::Reporter &to) -> void {
+    move_stacks(from, to, &CheckerStacks::reader_trace_stacks_);
+    move_stacks(from, to, &CheckerStacks::evaluator_trace_stacks_);
+  }
+};
+
+struct InteractorStacks : cplib::interactor::Reporter {
+  static auto move(cplib::interactor::Reporter &from, cplib::interactor::Reporter &to) -> void {
+    move_stacks(from, to, &InteractorStacks::trace_stacks_);
+  }
+};
+
+template <class Base>
+struct Mode;
+
+template <>
+struct Mode<cplib::checker::Initializer> {
+  using State = cplib::checker::State;
+  using Reporter = cplib::checker::Reporter;
+  using Report = cplib::checker::Report;
+  using Stacks = CheckerStacks;
+  static constexpr std::string_view NAME = "checker";
+
+  static auto attach(Reporter &reporter, const cplib::var::Reader &reader) -> void {
+    reporter.attach_reader_trace_stack(reader.make_trace_stack(false));
+  }
+
+  [[noreturn]] static auto fail(State &state, Stream stream, std::string_view message) -> void {
+    if (stream == Stream::OUF) state.quit_wa(message);
+    state.quit({Report::Status::INTERNAL_ERROR, 0.0, std::string(message)});
+  }
+};
+
+template <>
+struct Mode<cplib::interactor::Initializer> {
+  using State = cplib::interactor::State;
+  using Reporter = cplib::interactor::Reporter;
+  using Report = cplib::interactor::Report;
+  using Stacks = InteractorStacks;
+  static constexpr std::string_view NAME = "interactor";
+
+  static auto attach(Reporter &reporter, const cplib::var::Reader &reader) -> void {
+    reporter.attach_trace_stack(reader.make_trace_stack(false));
+  }
+
+  [[noreturn]] static auto fail(State &state, Stream stream, std::string_view message) -> void {
+    if (stream == Stream::FROM_USER) state.quit_wa(message);
+    state.quit({Report::Status::INTERNAL_ERROR, 0.0, std::string(message)});
+  }
+};
+
+// Times the platform's reporter, then writes the record.
+template <class Base>
+struct ProfiledReporter : Mode<Base>::Reporter {
+  using Report = typename Mode<Base>::Report;
+
+  explicit ProfiledReporter(std::unique_ptr<typename Mode<Base>::Reporter> inner)
+      : inner(std::move(inner)) {}
+
+  auto report(const Report &report) -> int override {
+    record.report_ns = now_ns();
+    if (perf) {
+      const auto at_report = perf->read();
+      record.read_counters = counters_at_last_read;
+      if (at_report && counters_at_last_read) {
+        record.evaluate_counters = difference(*counters_at_last_read, *at_report);
+      }
+    }
+    Mode<Base>::Stacks::move(*this, *inner);
+    record.exit_code = inner->report(report);
+    record.reported_ns = now_ns();
+    std::cout.flush();
+    std::clog.flush();
+    std::fflush(nullptr);
+    record.flushed_ns = now_ns();
+    write_record(record);
+    return record.exit_code;
+  }
+
+ private:
+  std::unique_ptr<typename Mode<Base>::Reporter> inner;
+};
+
+inline auto open_path(std::string_view path) -> int {
+  const auto fd = open(std::string(path).c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) cplib::panic(std::format("Failed to open {}: {}", path, std::strerror(errno)));
+  return fd;
+}
+}  // namespace detail
+
+/**
+ * Base of a profiled initializer. With `CPLIB_INITIALIZERS_PROFILE` set, the first `state()` call
+ * marks the start of `init`, `set_reporter` wraps the reporter so that the record is written after
+ * it reports, and the stream setters open their streams through `CountingBuf`.
+ */
+template <class Base>
+struct Profiled : Base {
+ protected:
+  using State = typename detail::Mode<Base>::State;
+
+  auto state() -> State & {
+    if (detail::enabled() && !detail::record.init_ns) {
+      detail::record.mode = detail::Mode<Base>::NAME;
+      detail::record.exec_ns = detail::EXEC_NS;
+      detail::record.init_ns = detail::now_ns();
+    }
+    return Base::state();
+  }
+
+  // Report through `reporter` from now on, including failures later in `init`.
+  auto set_reporter(std::unique_ptr<typename detail::Mode<Base>::Reporter> reporter) -> void {
+    if (detail::enabled()) {
+      reporter = std::make_unique<detail::ProfiledReporter<Base>>(std::move(reporter));
+    }
+    state().reporter = std::move(reporter);
+  }
+
+  auto set_inf_fileno(int fd, cplib::trace::Level trace_level) -> void {
+    if (!detail::enabled()) return Base::set_inf_fileno(fd, trace_level);
+    install(Base::state().inf, Stream::INF, fd, false, trace_level);
+  }
+
+  auto set_inf_path(std::string_view path, cplib::trace::Level trace_level) -> void {
+    if (!detail::enabled()) return Base::set_inf_path(path, trace_level);
+    install(Base::state().inf, Stream::INF, detail::open_path(path), true, trace_level);
+  }
+
+  auto set_ouf_fileno(int fd, cplib::trace::Level trace_level) -> void {
+    if (!detail::enabled()) return Base::set_ouf_fileno(fd, trace_level);
+    install(Base::state().ouf, Stream::OUF, fd, false, trace_level);
+  }
+
+  auto set_ouf_path(std::string_view path, cplib::trace::Level trace_level) -> void {
+    if (!detail::enabled()) return Base::set_ouf_path(path, trace_level);
+    install(Base::state().ouf, Stream::OUF, detail::open_path(path), true, trace_level);
+  }
+
+  auto set_ans_fileno(int fd, cplib::trace::Level trace_level) -> void {
+    if (!detail::enabled()) return Base::set_ans_fileno(fd, trace_level);
+    install(Base::state().ans, Stream::ANS, fd, false, trace_level);
+  }
+
+  auto set_ans_path(std::string_view path, cplib::trace::Level trace_level) -> void {
+    if (!detail::enabled()) return Base::set_ans_path(path, trace_level);
+    install(Base::state().ans, Stream::ANS, detail::open_path(path), true, trace_level);
+  }
+
+  /**
+   * Replace `reader` with one over `fd` for `stream`, which fails like the base class' readers.
+   * With a `limit`, `exceeded` is called once the stream is larger, see `detail::CountingBuf`.
+   * Without the profile, this only reads through `CountingBuf` for the limit's sake.
+   */
+  auto install(cplib::var::Reader &reader, Stream stream, int fd, bool owned,
+               cplib::trace::Level trace_level, std::uint64_t limit = 0,
+               std::function<void()> exceeded = {}) -> void {
+    auto &record = detail::record;
+    auto &state = Base::state();
+    if (detail::enabled() && !record.first_open_ns) record.first_open_ns = detail::now_ns();
+
+    const auto index = static_cast<std::size_t>(stream);
+    record.streams[index].opened = true;
+    reader = cplib::var::Reader(
+        std::make_unique<cplib::io::InStream>(
+            std::make_unique<detail::CountingBuf>(fd, owned, stream, limit, std::move(exceeded)),
+            std::string(STREAM_NAMES[index]), false),
+        trace_level,
+        [&state, stream, trace_level](const cplib::var::Reader &reader, std::string_view msg) {
+          if (trace_level >= cplib::trace::Level::STACK_ONLY) {
+            detail::Mode<Base>::attach(*state.reporter, reader);
+          }
+          detail::Mode<Base>::fail(state, stream, msg);
+        });
+    if (detail::enabled()) record.opened_ns = detail::now_ns();
+  }
+};
+}  // namespace cplib_initializers::common::profile
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ * This file is part of CPLibInitializers.
+ *
+ * CPLibInitializers is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * CPLibInitializers is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with
+ * CPLibInitializers. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file report_frame.hpp
+ *
+ * Binary report passed from the two-step interactor to its checker.
+ *
+ * Layout, little endian: the 4-byte magic `\x89C2S`, `u8 version` (1), `u8 status`, two zero
+ * bytes, the score as an IEEE-754 `f64`, `u64` message length, `u64` attachment length, the
+ * message, the attachment, and a `u32` CRC-32C of everything before it. The magic cannot begin a
+ * text report, whose first line is the status as a number.
+ */
+
+#ifndef CPLIB_INITIALIZERS_COMMON_REPORT_FRAME_HPP_
+#define CPLIB_INITIALIZERS_COMMON_REPORT_FRAME_HPP_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "crc32c.hpp"
+
+namespace cplib_initializers::common::report_frame {
+
+constexpr std::string_view MAGIC = "\x89"
+                                   "C2S";
+constexpr std::uint8_t VERSION = 1;
+constexpr std::size_t HEADER_SIZE = 32;
+constexpr std::size_t TRAILER_SIZE = 4;
+
+struct Frame {
+  std::uint8_t status;
+  double score;
+  // Views into the decoded data.
+  std::string_view message;
+  std::string_view attachment;
+};
+
+namespace detail {
+inline auto put(std::uint64_t value, int bytes, std::string &out) -> void {
+  for (int i = 0; i < bytes; ++i) out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+inline auto get(std::string_view data, std::size_t pos, int bytes) -> std::uint64_t {
+  std::uint64_t value = 0;
+  for (int i = 0; i < bytes; ++i) {
+    value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[pos + i])) << (8 * i);
+  }
+  return value;
+}
+}  // namespace detail
+
+/// Whether `data` starts like a frame, as opposed to a text report.
+inline auto is_frame(std::string_view data) -> bool { return data.starts_with(MAGIC); }
+
+inline auto encode(const Frame &frame) -> std::string {
+  std::string out;
+  out.reserve(HEADER_SIZE + frame.message.size() + frame.attachment.size() + TRAILER_SIZE);
+  out.append(MAGIC);
+  detail::put(VERSION, 1, out);
+  detail::put(frame.status, 1, out);
+  detail::put(0, 2, out);
+  detail::put(std::bit_cast<std::uint64_t>(frame.score), 8, out);
+  detail::put(frame.message.size(), 8, out);
+  detail::put(frame.attachment.size(), 8, out);
+  out.append(frame.message);
+  out.append(frame.attachment);
+  detail::put(crc32c::compute(out), 4, out);
+  return out;
+}
+
+/// Returns nullopt unless `data` is exactly one frame of a known version with a matching checksum.
+inline auto decode(std::string_view data) -> std::optional<Frame> {
+  if (data.size() < HEADER_SIZE + TRAILER_SIZE || !is_frame(data) ||
+      detail::get(data, 4, 1) != VERSION) {
+    return std::nullopt;
+  }
+  const auto message_size = detail::get(data, 16, 8);
+  const auto attachment_size = detail::get(data, 24, 8);
+  const auto payload_size = data.size() - HEADER_SIZE - TRAILER_SIZE;
+  if (message_size > payload_size || attachment_size != payload_size - message_size) {
+    return std::nullopt;
+  }
+  const auto body = data.substr(0, data.size() - TRAILER_SIZE);
+  if (crc32c::compute(body) != detail::get(data, body.size(), 4)) return std::nullopt;
+  return Frame{
+      .status = static_cast<std::uint8_t>(detail::get(data, 5, 1)),
+      .score = std::bit_cast<double>(detail::get(data, 8, 8)),
+      .message = data.substr(HEADER_SIZE, message_size),
+      .attachment = data.substr(HEADER_SIZE + message_size, attachment_size),
+  };
+}
+}  // namespace cplib_initializers::common::report_frame
+
+#endif
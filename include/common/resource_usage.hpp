@@ -0,0 +1,62 @@
+/*
+ * This file is part of CPLibInitializers.
+ *
+ * CPLibInitializers is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * CPLibInitializers is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with
+ * CPLibInitializers. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file resource_usage.hpp
+ *
+ * Opt-in resource usage line of a checker or interactor.
+ *
+ * Judges often run the checker in the submission's cgroup, so its memory counts against the
+ * contestant. When `CPLIB_INITIALIZERS_RESOURCE_USAGE` is set, reporters append the line returned
+ * by `line()` to the platform's diagnostic channel after the verdict.
+ */
+
+#ifndef CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_
+#define CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_
+
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <cstdlib>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace cplib_initializers::common::resource_usage {
+
+/// Set to append the resource usage to the platform's diagnostic channel.
+constexpr std::string_view ENV = "CPLIB_INITIALIZERS_RESOURCE_USAGE";
+
+/// `getrusage` of this process as one line, or nullopt unless `ENV` is set.
+inline auto line() -> std::optional<std::string> {
+  const auto *enabled = std::getenv(ENV.data());
+  rusage usage{};
+  if (enabled == nullptr || *enabled == '\0' || getrusage(RUSAGE_SELF, &usage) != 0) {
+    return std::nullopt;
+  }
+  const auto seconds = [](const timeval &time) {
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_usec) / 1e6;
+  };
+  return std::format(
+      "resource usage: max_rss={} KiB, minor_faults={}, major_faults={}, "
+      "voluntary_switches={}, involuntary_switches={}, user_time={:.3f} s, "
+      "system_time={:.3f} s",
+      usage.ru_maxrss, usage.ru_minflt, usage.ru_majflt, usage.ru_nvcsw, usage.ru_nivcsw,
+      seconds(usage.ru_utime), seconds(usage.ru_stime));
+}
+}  // namespace cplib_initializers::common::resource_usage
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ * This file is part of CPLibInitializers.
+ *
+ * CPLibInitializers is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * CPLibInitializers is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with
+ * CPLibInitializers. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file root.hpp
+ *
+ * Directory that initializers with fixed file names resolve them against.
+ *
+ * The root is `--root=<dir>`, a directory descriptor inherited as `--root-fd=<fd>`, or the working
+ * directory. Every file is opened with `openat` relative to it, so concurrent runs can share one
+ * working directory, each with a root of its own.
+ */
+
+#ifndef CPLIB_INITIALIZERS_COMMON_ROOT_HPP_
+#define CPLIB_INITIALIZERS_COMMON_ROOT_HPP_
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "cplib.hpp"
+
+namespace cplib_initializers::common::root {
+
+class Root {
+ public:
+  // The working directory.
+  Root() = default;
+
+  // The root chosen by `--root` or `--root-fd`, or the working directory.
+  explicit Root(const cplib::cmd_args::ParsedArgs &parsed_args) {
+    if (auto it = parsed_args.vars.find("root"); it != parsed_args.vars.end()) {
+      fd_ = ::open(it->second.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+      if (fd_ < 0) {
+        cplib::panic(std::format("Failed to open {}: {}", it->second, std::strerror(errno)));
+      }
+      owned_ = true;
+    } else if (auto it = parsed_args.vars.find("root-fd"); it != parsed_args.vars.end()) {
+      fd_ = cplib::var::i32("root-fd", 0, std::nullopt).parse(it->second);
+    }
+  }
+
+  Root(const Root &) = delete;
+  auto operator=(const Root &) -> Root & = delete;
+
+  // Closes the directory if it was opened for `--root`; an inherited one stays open.
+  ~Root() {
+    if (owned_) close(fd_);
+  }
+
+  [[nodiscard]] auto fd() const -> int { return fd_; }
+
+  // Open `name` with `flags`, by default for reading, or panic.
+  [[nodiscard]] auto open(std::string_view name, int flags = O_RDONLY) const -> int {
+    int fd;
+    do {
+      fd = openat(fd_, std::string(name).c_str(), flags | O_CLOEXEC);
+    } while (fd < 0 && errno == EINTR);
+    if (fd < 0) cplib::panic(std::format("Failed to open {}: {}", name, std::strerror(errno)));
+    return fd;
+  }
+
+  // Replace the file `name` with `content`, created with the umask applied to 0666. Returns false,
+  // with `errno` set, if it cannot be written.
+  [[nodiscard]] auto try_write(std::string_view name, std::string_view content) const -> bool {
+    int fd;
+    do {
+      fd = openat(fd_, std::string(name).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    } while (fd < 0 && errno == EINTR);
+    if (fd < 0) return false;
+    while (!content.empty()) {
+      const auto written = ::write(fd, content.data(), content.size());
+      if (written < 0 && errno == EINTR) continue;
+      if (written <= 0) {
+        const auto error = written < 0 ? errno : ENOSPC;
+        close(fd);
+        errno = error;
+        return false;
+      }
+      content.remove_prefix(static_cast<std::size_t>(written));
+    }
+    return close(fd) == 0;
+  }
+
+  // Replace the file `name` with `content` like `try_write`, or panic.
+  auto write(std::string_view name, std::string_view content) const -> void {
+    if (!try_write(name, content)) {
+      cplib::panic(std::format("Failed to write {}: {}", name, std::strerror(errno)));
+    }
+  }
+
+ private:
+  int fd_ = AT_FDCWD;
+  bool owned_ = false;
+};
+}  // namespace cplib_initializers::common::root
+
+#endif
@@ -0,0 +1,362 @@
+/*
+ * This file is part of CPLibInitializers.
+ *
+ * CPLibInitializers is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * CPLibInitializers is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with
+ * CPLibInitializers. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file server.hpp
+ *
+ * Warm interactor processes that serve many sessions.
+ *
+ * Starting an interactor (exec, initialization, parsing `inf`) happens before the contestant gets
+ * its first byte, so it counts toward the interaction's wall time. In server mode the interactor
+ * does that work once, then listens on a UNIX socket. A judge, or `tools/interactor_client`
+ * standing in for the interactor command, connects and passes the session's stdin, stdout and
+ * report descriptors with `SCM_RIGHTS`. The server forks a child for the session, which takes these
+ * descriptors over and continues exactly like a freshly started interactor. When the child exits,
+ * its exit code is sent back on the connection as a native-endian `int32_t`.
+ *
+ * Everything else comes from the server: its arguments, and any file it has opened. A session must
+ * therefore report on the passed report descriptor only, which is why platforms that write their
+ * verdict to files refuse server mode. Sessions skip exec and initialization, but parse `inf` on
+ * their own unless a `warmup` hook parses it in the server.
+ */
+
+#ifndef CPLIB_INITIALIZERS_COMMON_SERVER_HPP_
+#define CPLIB_INITIALIZERS_COMMON_SERVER_HPP_
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace cplib_initializers::common::server {
+
+// Socket path to serve sessions on, if the interactor should run as a server.
+constexpr std::string_view SOCKET_ENV = "CPLIB_INITIALIZERS_SERVER";
+
+// Number of descriptors a session passes: stdin, stdout and the report channel.
+constexpr std::size_t SESSION_FDS = 3;
+
+struct Options {
+  // UNIX socket to accept sessions on. Empty to run a single session as usual.
+  std::string socket_path{};
+  // Run once in the server before the first session is accepted, e.g. to parse `inf` into global
+  // variables. Every session starts from the state it leaves behind.
+  std::function<void()> warmup{};
+};
+
+namespace detail {
+inline auto make_address(const std::string &path) -> std::optional<sockaddr_un> {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) return std::nullopt;
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  return address;
+}
+
+inline auto send_fds(int socket, const std::array<int, SESSION_FDS> &fds) -> bool {
+  char byte = 0;
+  iovec data{&byte, 1};
+  alignas(cmsghdr) std::array<char, CMSG_SPACE(sizeof(int) * SESSION_FDS)> control{};
+  msghdr message{};
+  message.msg_iov = &data;
+  message.msg_iovlen = 1;
+  message.msg_control = control.data();
+  message.msg_controllen = control.size();
+  auto *header = CMSG_FIRSTHDR(&message);
+  header->cmsg_level = SOL_SOCKET;
+  header->cmsg_type = SCM_RIGHTS;
+  header->cmsg_len = CMSG_LEN(sizeof(int) * SESSION_FDS);
+  std::memcpy(CMSG_DATA(header), fds.data(), sizeof(int) * SESSION_FDS);
+  while (true) {
+    if (sendmsg(socket, &message, MSG_NOSIGNAL) == 1) return true;
+    if (errno != EINTR) return false;
+  }
+}
+
+inline auto receive_fds(int socket) -> std::optional<std::array<int, SESSION_FDS>> {
+  char byte;
+  iovec data{&byte, 1};
+  alignas(cmsghdr) std::array<char, CMSG_SPACE(sizeof(int) * SESSION_FDS)> control{};
+  msghdr message{};
+  message.msg_iov = &data;
+  message.msg_iovlen = 1;
+  message.msg_control = control.data();
+  message.msg_controllen = control.size();
+  ssize_t size;
+  do {
+    size = recvmsg(socket, &message, MSG_CMSG_CLOEXEC);
+  } while (size < 0 && errno == EINTR);
+
+  auto *header = CMSG_FIRSTHDR(&message);
+  if (header == nullptr || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+    return std::nullopt;
+  }
+  const auto count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+  std::array<int, SESSION_FDS> fds{};
+  std::memcpy(fds.data(), CMSG_DATA(header), std::min(count, SESSION_FDS) * sizeof(int));
+  if (size == 1 && count == SESSION_FDS && (message.msg_flags & MSG_CTRUNC) == 0) return fds;
+  for (std::size_t i = 0; i < std::min(count, SESSION_FDS); ++i) close(fds[i]);
+  return std::nullopt;
+}
+
+inline auto write_all(int fd, const void *data, std::size_t size) -> bool {
+  const auto *bytes = static_cast<const char *>(data);
+  while (size > 0) {
+    auto written = send(fd, bytes, size, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    bytes += written;
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+inline auto read_all(int fd, void *data, std::size_t size) -> bool {
+  auto *bytes = static_cast<char *>(data);
+  while (size > 0) {
+    auto received = read(fd, bytes, size);
+    if (received < 0 && errno == EINTR) continue;
+    if (received <= 0) return false;
+    bytes += received;
+    size -= static_cast<std::size_t>(received);
+  }
+  return true;
+}
+
+// Exit code of a finished session; a session killed by a signal reports `128 + signal` like a
+// shell does.
+inline auto exit_code(int status) -> std::int32_t {
+  if (WIFEXITED(status)) return WEXITSTATUS(status);
+  if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+  return 128;
+}
+
+inline auto pidfd_open(pid_t pid) -> int {
+#ifdef SYS_pidfd_open
+  return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+  return -1;
+#endif
+}
+
+// Descriptors open in this process that refer to regular files opened for reading only, such as
+// `inf`.
+inline auto input_files() -> std::vector<int> {
+  std::vector<int> fds;
+  std::error_code ec;
+  for (const auto &entry : std::filesystem::directory_iterator("/proc/self/fd", ec)) {
+    const auto name = entry.path().filename().string();
+    int fd;
+    auto [ptr, parse_ec] = std::from_chars(name.data(), name.data() + name.size(), fd);
+    if (parse_ec == std::errc() && ptr == name.data() + name.size()) fds.push_back(fd);
+  }
+  std::erase_if(fds, [](int fd) {
+    struct stat info{};
+    const auto flags = fcntl(fd, F_GETFL);
+    return fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || flags < 0 ||
+           (flags & O_ACCMODE) != O_RDONLY;
+  });
+  return fds;
+}
+
+// Forked sessions would share the file offsets of the server's open inputs, so that one session
+// reading `inf` moves it for the others. Give each of them a private open file description at the
+// same offset.
+inline auto unshare_inputs() -> void {
+  for (auto fd : input_files()) {
+    const auto offset = lseek(fd, 0, SEEK_CUR);
+    const auto fd_flags = fcntl(fd, F_GETFD);
+    const auto private_fd =
+        open(("/proc/self/fd/" + std::to_string(fd)).c_str(), fcntl(fd, F_GETFL) | O_CLOEXEC);
+    if (private_fd < 0) continue;
+    if (offset >= 0) lseek(private_fd, offset, SEEK_SET);
+    dup3(private_fd, fd, (fd_flags & FD_CLOEXEC) != 0 ? O_CLOEXEC : 0);
+    close(private_fd);
+  }
+}
+
+// Ask for the server's inputs to be read into the page cache before the first session.
+inline auto preload_inputs() -> void {
+  for (auto fd : input_files()) posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+}
+
+// Move the received descriptors onto `targets`, in the session child.
+inline auto take_over(const std::array<int, SESSION_FDS> &received,
+                      const std::array<int, SESSION_FDS> &targets) -> void {
+  // A received descriptor may occupy another one's target, so move them all out of the way first.
+  const auto above = *std::max_element(targets.begin(), targets.end()) + 1;
+  std::array<int, SESSION_FDS> moved{};
+  for (std::size_t i = 0; i < SESSION_FDS; ++i) {
+    moved[i] = fcntl(received[i], F_DUPFD_CLOEXEC, above);
+    close(received[i]);
+  }
+  for (std::size_t i = 0; i < SESSION_FDS; ++i) {
+    dup2(moved[i], targets[i]);
+    close(moved[i]);
+  }
+}
+
+inline auto listen_on(const std::string &path) -> int {
+  const auto address = make_address(path);
+  if (!address.has_value()) return -1;
+  const auto fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) return -1;
+  unlink(path.c_str());
+  if (bind(fd, reinterpret_cast<const sockaddr *>(&*address), sizeof(*address)) != 0 ||
+      listen(fd, SOMAXCONN) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+struct Session {
+  int connection;
+  pid_t pid;
+  int pidfd;
+};
+
+inline auto finish(const Session &session) -> void {
+  int status = 0;
+  while (waitpid(session.pid, &status, 0) < 0 && errno == EINTR) {
+  }
+  const auto code = exit_code(status);
+  write_all(session.connection, &code, sizeof(code));
+  close(session.connection);
+  if (session.pidfd >= 0) close(session.pidfd);
+}
+}  // namespace detail
+
+/**
+ * Serve sessions on `options.socket_path`, forever. Returns true in the child of each session,
+ * after the descriptors passed by the client have been moved onto `targets` (the interactor's
+ * stdin, stdout and report descriptors, in that order). Returns false without serving if the socket
+ * cannot be set up.
+ */
+inline auto serve(const Options &options, const std::array<int, SESSION_FDS> &targets) -> bool {
+  const auto listener = detail::listen_on(options.socket_path);
+  if (listener < 0) return false;
+  if (options.warmup) options.warmup();
+  detail::preload_inputs();
+  std::fflush(nullptr);
+
+  std::vector<detail::Session> sessions;
+  std::vector<pollfd> entries;
+  while (true) {
+    entries.clear();
+    entries.push_back({listener, POLLIN, 0});
+    for (const auto &session : sessions) entries.push_back({session.pidfd, POLLIN, 0});
+    if (poll(entries.data(), entries.size(), -1) < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+
+    for (std::size_t i = sessions.size(); i-- > 0;) {
+      if (entries[i + 1].revents == 0) continue;
+      detail::finish(sessions[i]);
+      sessions.erase(sessions.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+    if (entries[0].revents == 0) continue;
+
+    const auto connection = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+    if (connection < 0) continue;
+    const auto received = detail::receive_fds(connection);
+    if (!received.has_value()) {
+      close(connection);
+      continue;
+    }
+
+    const auto pid = fork();
+    if (pid == 0) {
+      close(listener);
+      close(connection);
+      for (const auto &session : sessions) {
+        close(session.connection);
+        close(session.pidfd);
+      }
+      detail::unshare_inputs();
+      detail::take_over(*received, targets);
+      return true;
+    }
+    for (auto fd : *received) close(fd);
+    if (pid < 0) {
+      close(connection);
+      continue;
+    }
+
+    const detail::Session session{connection, pid, detail::pidfd_open(pid)};
+    // Without pidfds the server cannot wait for several sessions at once, so it runs them in turn.
+    if (session.pidfd < 0) {
+      detail::finish(session);
+    } else {
+      sessions.push_back(session);
+    }
+  }
+}
+
+/**
+ * Run a session on the server listening at `socket_path`, passing it `fds` (stdin, stdout and the
+ * report descriptor). `fds[0]` and `fds[1]` are closed once passed, so that the contestant sees its
+ * channels close when the session ends. Returns the session's exit code, or nothing if the server
+ * cannot be reached or the session is lost.
+ */
+inline auto run_session(const std::string &socket_path, const std::array<int, SESSION_FDS> &fds)
+    -> std::optional<std::int32_t> {
+  const auto address = detail::make_address(socket_path);
+  if (!address.has_value()) return std::nullopt;
+  const auto connection = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (connection < 0) return std::nullopt;
+
+  int result;
+  do {
+    result = connect(connection, reinterpret_cast<const sockaddr *>(&*address), sizeof(*address));
+  } while (result != 0 && errno == EINTR);
+  if (result != 0 || !detail::send_fds(connection, fds)) {
+    close(connection);
+    return std::nullopt;
+  }
+  close(fds[0]);
+  close(fds[1]);
+
+  std::int32_t code;
+  const auto ok = detail::read_all(connection, &code, sizeof(code));
+  close(connection);
+  return ok ? std::optional(code) : std::nullopt;
+}
+}  // namespace cplib_initializers::common::server
+
+#endif
@@ -0,0 +1,326 @@
+/*
+ * This file is part of CPLibInitializers.
+ *
+ * CPLibInitializers is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * CPLibInitializers is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with
+ * CPLibInitializers. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tracer.hpp
+ *
+ * Per-round latency tracer for the interactor contestant channel.
+ *
+ * Every `write` to `to_user` and every `read` from `from_user` is logged as a fixed-size binary
+ * event. A round is a `to_user` write followed by the first `from_user` arrival after it, and its
+ * latency is the time between the two. At exit the tracer writes a plain text summary next to the
+ * event log; `tools/decode_interaction_trace.cpp` prints both from an existing log.
+ *
+ * Event log layout (little-endian): the 8-byte magic `CPLIBTR1`, then one 21-byte record per
+ * event: `u64 time_ns` (monotonic, since the tracer started), `u64 cpu_ns` (interactor CPU time
+ * since the tracer started), `u32 bytes`, `u8 kind` (0 = to_user, 1 = from_user).
+ */
+
+#ifndef CPLIB_INITIALIZERS_COMMON_TRACER_HPP_
+#define CPLIB_INITIALIZERS_COMMON_TRACER_HPP_
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <format>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace cplib_initializers::common::tracer {
+
+constexpr std::string_view MAGIC = "CPLIBTR1";
+constexpr std::size_t EVENT_SIZE = 21;
+
+enum struct EventKind : std::uint8_t {
+  TO_USER = 0,
+  FROM_USER = 1,
+};
+
+struct Event {
+  std::uint64_t time_ns;
+  std::uint64_t cpu_ns;
+  std::uint32_t bytes;
+  EventKind kind;
+};
+
+namespace detail {
+inline auto put_le(char *out, std::uint64_t value, std::size_t width) -> void {
+  for (std::size_t i = 0; i < width; ++i) {
+    out[i] = static_cast<char>((value >> (i * 8)) & 0xff);
+  }
+}
+
+inline auto get_le(const char *in, std::size_t width) -> std::uint64_t {
+  std::uint64_t value = 0;
+  for (std::size_t i = 0; i < width; ++i) {
+    value |= static_cast<std::uint64_t>(static_cast<unsigned char>(in[i])) << (i * 8);
+  }
+  return value;
+}
+
+inline auto write_all(int fd, const char *data, std::size_t size) -> bool {
+  while (size > 0) {
+    auto written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += written;
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+inline auto cpu_time_ns() -> std::uint64_t {
+  timespec now{};
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+  return static_cast<std::uint64_t>(now.tv_sec) * 1'000'000'000 +
+         static_cast<std::uint64_t>(now.tv_nsec);
+}
+}  // namespace detail
+
+inline auto encode(const Event &event, char *out) -> void {
+  detail::put_le(out, event.time_ns, 8);
+  detail::put_le(out + 8, event.cpu_ns, 8);
+  detail::put_le(out + 16, event.bytes, 4);
+  out[20] = static_cast<char>(event.kind);
+}
+
+inline auto decode(std::string_view data) -> std::optional<std::vector<Event>> {
+  if (!data.starts_with(MAGIC) || (data.size() - MAGIC.size()) % EVENT_SIZE != 0) {
+    return std::nullopt;
+  }
+  std::vector<Event> events;
+  events.reserve((data.size() - MAGIC.size()) / EVENT_SIZE);
+  for (auto i = MAGIC.size(); i < data.size(); i += EVENT_SIZE) {
+    const auto *record = data.data() + i;
+    if (static_cast<unsigned char>(record[20]) > 1) return std::nullopt;
+    events.push_back({
+        .time_ns = detail::get_le(record, 8),
+        .cpu_ns = detail::get_le(record + 8, 8),
+        .bytes = static_cast<std::uint32_t>(detail::get_le(record + 16, 4)),
+        .kind = static_cast<EventKind>(record[20]),
+    });
+  }
+  return events;
+}
+
+/**
+ * Log-linear histogram of nanosecond durations: 8 linear sub-buckets per power of two, so
+ * reported percentiles are within 12.5% of the exact value. The maximum is exact.
+ */
+class Histogram {
+ public:
+  auto add(std::uint64_t value) -> void {
+    ++buckets_[bucket_of(value)];
+    ++count_;
+    max_ = std::max(max_, value);
+  }
+
+  [[nodiscard]] auto count() const -> std::uint64_t { return count_; }
+
+  [[nodiscard]] auto max() const -> std::uint64_t { return max_; }
+
+  // Upper bound of the bucket holding the given quantile, clamped to the maximum.
+  [[nodiscard]] auto percentile(double quantile) const -> std::uint64_t {
+    if (count_ == 0) return 0;
+    auto rank = static_cast<std::uint64_t>(quantile * static_cast<double>(count_ - 1)) + 1;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets_.size(); ++i) {
+      seen += buckets_[i];
+      if (seen >= rank) return std::min(upper_bound_of(i), max_);
+    }
+    return max_;
+  }
+
+  // Non-empty buckets as (inclusive upper bound, count) pairs.
+  [[nodiscard]] auto rows() const -> std::vector<std::pair<std::uint64_t, std::uint64_t>> {
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> result;
+    for (std::size_t i = 0; i < buckets_.size(); ++i) {
+      if (buckets_[i] != 0) result.emplace_back(upper_bound_of(i), buckets_[i]);
+    }
+    return result;
+  }
+
+ private:
+  static constexpr std::size_t SUB_BITS = 3;
+  static constexpr std::size_t SUB_BUCKETS = 1 << SUB_BITS;
+
+  static auto bucket_of(std::uint64_t value) -> std::size_t {
+    if (value < SUB_BUCKETS) return static_cast<std::size_t>(value);
+    const auto exponent = static_cast<std::size_t>(std::bit_width(value)) - 1;
+    const auto sub = static_cast<std::size_t>(value >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return (exponent - SUB_BITS + 1) * SUB_BUCKETS + sub;
+  }
+
+  static auto upper_bound_of(std::size_t bucket) -> std::uint64_t {
+    if (bucket < SUB_BUCKETS) return bucket;
+    const auto exponent = bucket / SUB_BUCKETS + SUB_BITS - 1;
+    const auto sub = bucket % SUB_BUCKETS;
+    const auto width = std::uint64_t{1} << (exponent - SUB_BITS);
+    return (std::uint64_t{1} << exponent) + (sub + 1) * width - 1;
+  }
+
+  std::array<std::uint64_t, (64 - SUB_BITS + 1) * SUB_BUCKETS> buckets_{};
+  std::uint64_t count_{};
+  std::uint64_t max_{};
+};
+
+/// Aggregates events into per-round statistics.
+class Summary {
+ public:
+  auto add(const Event &event) -> void {
+    if (event.kind == EventKind::TO_USER) {
+      bytes_to_user_ += event.bytes;
+      ++writes_;
+      if (!awaiting_response_) {
+        cpu_.add(event.cpu_ns - last_arrival_cpu_ns_);
+        round_start_ns_ = event.time_ns;
+        awaiting_response_ = true;
+      }
+    } else {
+      bytes_from_user_ += event.bytes;
+      ++reads_;
+      if (awaiting_response_) {
+        latency_.add(event.time_ns - round_start_ns_);
+        awaiting_response_ = false;
+      }
+      last_arrival_cpu_ns_ = event.cpu_ns;
+    }
+  }
+
+  [[nodiscard]] auto latency() const -> const Histogram & { return latency_; }
+
+  [[nodiscard]] auto to_string() const -> std::string {
+    constexpr auto us = [](std::uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+    std::string result = std::format(
+        "rounds: {}\n"
+        "to_user: {} bytes in {} writes\n"
+        "from_user: {} bytes in {} reads\n"
+        "round latency (us): p50 {:.1f}, p99 {:.1f}, max {:.1f}\n"
+        "interactor cpu per round (us): p50 {:.1f}, p99 {:.1f}, max {:.1f}\n"
+        "round latency histogram (us):\n",
+        latency_.count(), bytes_to_user_, writes_, bytes_from_user_, reads_,
+        us(latency_.percentile(0.5)), us(latency_.percentile(0.99)), us(latency_.max()),
+        us(cpu_.percentile(0.5)), us(cpu_.percentile(0.99)), us(cpu_.max()));
+    for (const auto &[upper_bound, count] : latency_.rows()) {
+      result += std::format("  <= {:>12.1f}: {}\n", us(upper_bound), count);
+    }
+    return result;
+  }
+
+ private:
+  Histogram latency_;
+  Histogram cpu_;
+  std::uint64_t bytes_to_user_{};
+  std::uint64_t bytes_from_user_{};
+  std::uint64_t writes_{};
+  std::uint64_t reads_{};
+  std::uint64_t round_start_ns_{};
+  std::uint64_t last_arrival_cpu_ns_{};
+  bool awaiting_response_{};
+};
+
+/**
+ * Writes the event log to `path` and the summary to `path + ".summary"` when finished. Events are
+ * batched in memory, so recording one costs two clock reads and a copy.
+ */
+class Tracer {
+ public:
+  explicit Tracer(std::string path)
+      : path_(std::move(path)),
+        start_(std::chrono::steady_clock::now()),
+        start_cpu_ns_(detail::cpu_time_ns()) {
+    do {
+      fd_ = open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    } while (fd_ < 0 && errno == EINTR);
+    buffer_.reserve(BUFFER_SIZE);
+    buffer_.append(MAGIC);
+  }
+
+  Tracer(const Tracer &) = delete;
+  auto operator=(const Tracer &) -> Tracer & = delete;
+
+  ~Tracer() { finish(); }
+
+  [[nodiscard]] auto is_open() const -> bool { return fd_ >= 0; }
+
+  auto record(EventKind kind, std::size_t bytes) -> void {
+    if (fd_ < 0) return;
+    const Event event{
+        .time_ns = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                 start_)
+                .count()),
+        .cpu_ns = detail::cpu_time_ns() - start_cpu_ns_,
+        .bytes = static_cast<std::uint32_t>(
+            std::min<std::size_t>(bytes, std::numeric_limits<std::uint32_t>::max())),
+        .kind = kind,
+    };
+    summary_.add(event);
+    std::array<char, EVENT_SIZE> record{};
+    encode(event, record.data());
+    buffer_.append(record.data(), record.size());
+    if (buffer_.size() + EVENT_SIZE > BUFFER_SIZE) flush();
+  }
+
+  // Write out the remaining events and the summary. Later events are ignored.
+  auto finish() -> void {
+    if (fd_ < 0) return;
+    flush();
+    close(fd_);
+    fd_ = -1;
+
+    int summary_fd;
+    do {
+      summary_fd =
+          open((path_ + ".summary").c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    } while (summary_fd < 0 && errno == EINTR);
+    if (summary_fd < 0) return;
+    const auto text = summary_.to_string();
+    detail::write_all(summary_fd, text.data(), text.size());
+    close(summary_fd);
+  }
+
+ private:
+  static constexpr std::size_t BUFFER_SIZE = 1 << 16;
+
+  auto flush() -> void {
+    detail::write_all(fd_, buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+
+  std::string path_;
+  int fd_{-1};
+  std::chrono::steady_clock::time_point start_;
+  std::uint64_t start_cpu_ns_;
+  std::string buffer_;
+  Summary summary_;
+};
+}  // namespace cplib_initializers::common::tracer
+
+#endif
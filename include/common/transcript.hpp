@@ -0,0 +1,235 @@
+/*
+ * This file is part of CPLibInitializers.
+ *
+ * CPLibInitializers is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * CPLibInitializers is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with
+ * CPLibInitializers. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file transcript.hpp
+ *
+ * Record and replay of the bytes exchanged with a contestant.
+ *
+ * A recorded transcript holds the `to_user` and `from_user` streams in the order they were
+ * transferred. Replaying it feeds the recorded `from_user` stream to an interactor, without a
+ * contestant, and checks that the interactor writes the same `to_user` bytes. A deterministic
+ * contestant would then have answered exactly as recorded, so the replayed verdict is the verdict
+ * a full rerun would give.
+ *
+ * File layout: the 8-byte magic `CPLIBRR1`, then chunks of `u8 kind` (0 = to_user, 1 = from_user,
+ * 2 = end of from_user, 3 = interactor state), a LEB128 length and that many bytes. Interactor
+ * state is opaque data an interactor stores alongside the streams, e.g. for a two-step checker.
+ */
+
+#ifndef CPLIB_INITIALIZERS_COMMON_TRANSCRIPT_HPP_
+#define CPLIB_INITIALIZERS_COMMON_TRANSCRIPT_HPP_
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace cplib_initializers::common::transcript {
+
+constexpr std::string_view MAGIC = "CPLIBRR1";
+
+enum struct ChunkKind : std::uint8_t {
+  TO_USER = 0,
+  FROM_USER = 1,
+  FROM_USER_EOF = 2,
+  STATE = 3,
+};
+
+namespace detail {
+inline auto write_all(int fd, const char *data, std::size_t size) -> bool {
+  while (size > 0) {
+    auto written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += written;
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+}  // namespace detail
+
+// Append a chunk to `out`.
+inline auto encode_chunk(ChunkKind kind, std::string_view data, std::string &out) -> void {
+  out.push_back(static_cast<char>(kind));
+  auto size = static_cast<std::uint64_t>(data.size());
+  do {
+    auto byte = static_cast<std::uint8_t>(size & 0x7f);
+    size >>= 7;
+    if (size != 0) byte |= 0x80;
+    out.push_back(static_cast<char>(byte));
+  } while (size != 0);
+  out.append(data);
+}
+
+/// The two streams of a transcript.
+struct Transcript {
+  std::string to_user;
+  std::string from_user;
+  bool from_user_eof = false;
+  std::string state;
+};
+
+inline auto decode(std::string_view data) -> std::optional<Transcript> {
+  if (!data.starts_with(MAGIC)) return std::nullopt;
+  Transcript transcript;
+  std::size_t pos = MAGIC.size();
+  while (pos < data.size()) {
+    const auto kind = static_cast<std::uint8_t>(data[pos++]);
+    std::uint64_t size = 0;
+    for (int shift = 0;; shift += 7) {
+      if (pos >= data.size() || shift > 63) return std::nullopt;
+      const auto byte = static_cast<std::uint8_t>(data[pos++]);
+      size |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) break;
+    }
+    if (size > data.size() - pos) return std::nullopt;
+    const auto chunk = data.substr(pos, size);
+    pos += size;
+    switch (static_cast<ChunkKind>(kind)) {
+      case ChunkKind::TO_USER:
+        transcript.to_user.append(chunk);
+        break;
+      case ChunkKind::FROM_USER:
+        transcript.from_user.append(chunk);
+        break;
+      case ChunkKind::FROM_USER_EOF:
+        transcript.from_user_eof = true;
+        break;
+      case ChunkKind::STATE:
+        transcript.state.append(chunk);
+        break;
+      default:
+        return std::nullopt;
+    }
+  }
+  return transcript;
+}
+
+inline auto load(const std::string &path) -> std::optional<Transcript> {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return std::nullopt;
+  const std::string data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  return decode(data);
+}
+
+/**
+ * Writes a transcript to a file. Chunks are batched in memory and written out when the batch is
+ * full and on `finish`, so recording costs a copy per transfer.
+ *
+ * With `keep`, the whole transcript is also kept in memory, and `path` may be empty to record to
+ * memory only.
+ */
+class Recorder {
+ public:
+  explicit Recorder(const std::string &path, bool keep = false) : keep_(keep) {
+    if (!path.empty()) {
+      do {
+        fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+      } while (fd_ < 0 && errno == EINTR);
+    }
+    buffer_.append(MAGIC);
+  }
+
+  Recorder(const Recorder &) = delete;
+  auto operator=(const Recorder &) -> Recorder & = delete;
+
+  ~Recorder() { finish(); }
+
+  [[nodiscard]] auto is_open() const -> bool { return fd_ >= 0; }
+
+  auto record(ChunkKind kind, std::string_view data) -> void {
+    if (finished_ || (fd_ < 0 && !keep_)) return;
+    encode_chunk(kind, data, buffer_);
+    if (buffer_.size() >= BUFFER_SIZE) flush();
+  }
+
+  // Write out the remaining chunks. Later chunks are ignored.
+  auto finish() -> void {
+    if (finished_) return;
+    flush();
+    if (fd_ >= 0) close(fd_);
+    fd_ = -1;
+    finished_ = true;
+  }
+
+  // The transcript kept in memory, complete once finished. Empty unless constructed with `keep`.
+  [[nodiscard]] auto kept() const -> const std::string & { return kept_; }
+
+ private:
+  static constexpr std::size_t BUFFER_SIZE = 1 << 16;
+
+  auto flush() -> void {
+    if (fd_ >= 0) detail::write_all(fd_, buffer_.data(), buffer_.size());
+    if (keep_) kept_.append(buffer_);
+    buffer_.clear();
+  }
+
+  int fd_{-1};
+  bool keep_;
+  bool finished_{};
+  std::string buffer_;
+  std::string kept_;
+};
+
+/// Serves a loaded transcript in place of a contestant.
+class Replay {
+ public:
+  explicit Replay(Transcript transcript) : transcript_(std::move(transcript)) {}
+
+  // Copy up to `size` recorded `from_user` bytes. Returns zero at the end of the recorded stream.
+  auto read(char *data, std::size_t size) -> std::size_t {
+    size = std::min(size, transcript_.from_user.size() - read_);
+    std::memcpy(data, transcript_.from_user.data() + read_, size);
+    read_ += size;
+    return size;
+  }
+
+  // Whether the recorded contestant closed `from_user` where the recorded stream ends.
+  [[nodiscard]] auto from_user_eof() const -> bool { return transcript_.from_user_eof; }
+
+  // Compare `data` with the next recorded `to_user` bytes. Returns false on divergence.
+  auto expect(std::string_view data) -> bool {
+    if (data.size() > transcript_.to_user.size() - written_ ||
+        transcript_.to_user.compare(written_, data.size(), data) != 0) {
+      return false;
+    }
+    written_ += data.size();
+    return true;
+  }
+
+  // Number of `to_user` bytes matched so far.
+  [[nodiscard]] auto written() const -> std::size_t { return written_; }
+
+ private:
+  Transcript transcript_;
+  std::size_t read_ = 0;
+  std::size_t written_ = 0;
+};
+}  // namespace cplib_initializers::common::transcript
+
+#endif
@@ -24,12 +24,60 @@
 #include <ios>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 
+#if __has_include("../common/checker.hpp")
+#include "../common/checker.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_
+// Stand-in for common/checker.hpp when this header is used on its own: the whole output is read,
+// with no output limit, early exit or profile.
+namespace cplib_initializers::common::checker {
+template <class Status>
+constexpr auto counts_as_accepted(Status status, double score) -> bool {
+  return status == Status::ACCEPTED || score == 1.0;
+}
+
+inline auto early_exit() -> bool { return false; }
+
+inline auto quit_unless_accepted(const cplib::evaluate::Result &result)
+    -> const cplib::evaluate::Result & {
+  return result;
+}
+
+struct Options {};
+
+struct Initializer : cplib::checker::Initializer {
+  Initializer() = default;
+
+  explicit Initializer(Options) {}
+
+ protected:
+  auto enable_early_exit(bool) -> void {}
+
+  auto set_reporter(std::unique_ptr<cplib::checker::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
+  }
+};
+}  // namespace cplib_initializers::common::checker
+#endif
+
+#if __has_include("../common/resource_usage.hpp")
+#include "../common/resource_usage.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_
+// Stand-in for common/resource_usage.hpp when this header is used on its own: no usage line.
+namespace cplib_initializers::common::resource_usage {
+inline auto line() -> std::optional<std::string> { return std::nullopt; }
+}  // namespace cplib_initializers::common::resource_usage
+#endif
+
 namespace cplib_initializers::kattis::checker {
 
 constexpr int EXITCODE_JE = 1;
@@ -59,6 +107,13 @@ struct Reporter : cplib::checker::Reporter {
         score(std::format("{}/{}", feedback_dir, FILENAME_SCORE), std::ios_base::binary) {}
 
   auto report(const Report &report) -> int override {
+    const auto exit_code = report_verdict(report);
+    if (const auto usage = common::resource_usage::line()) judge_error << *usage << '\n';
+    return exit_code;
+  }
+
+ private:
+  auto report_verdict(const Report &report) -> int {
     switch (report.status) {
       case Status::INTERNAL_ERROR:
         judge_error << "FAIL " << report.message << '\n';
@@ -79,7 +134,6 @@ struct Reporter : cplib::checker::Reporter {
     }
   }
 
- private:
   std::ofstream judge_message, judge_error, score;
 };
 
@@ -101,12 +155,12 @@ inline auto print_help_message(std::string_view program_name) -> void {
 }
 }  // namespace detail
 
-struct Initializer : cplib::checker::Initializer {
-  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
+struct Initializer : common::checker::Initializer {
+  using common::checker::Initializer::Initializer;
 
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
     // Use PlainTextReporter to handle errors during the init process
-    state.reporter = std::make_unique<cplib::checker::PlainTextReporter>();
+    set_reporter(std::make_unique<cplib::checker::PlainTextReporter>());
 
     auto parsed_args = cplib::cmd_args::ParsedArgs(args);
 
@@ -127,7 +181,7 @@ struct Initializer : cplib::checker::Initializer {
       cplib::panic(feedback_dir + " is not a directory");
     }
 
-    state.reporter = std::make_unique<Reporter>(feedback_dir);
+    set_reporter(std::make_unique<Reporter>(feedback_dir));
 
     set_inf_path(inf, cplib::trace::Level::NONE);
     set_ouf_fileno(fileno(stdin), cplib::trace::Level::NONE);
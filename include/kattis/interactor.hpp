@@ -26,13 +26,61 @@
 #include <ios>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 
+#if __has_include("../common/interactor.hpp")
+#include "../common/interactor.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_
+// Stand-in for common/interactor.hpp when this header is used on its own: the contestant is
+// connected through cplib's own streams, with no contestant channel or profile.
+namespace cplib_initializers::common {
+namespace channel {
+struct Options {};
+}  // namespace channel
+
+namespace interactor {
+struct Initializer : cplib::interactor::Initializer {
+  Initializer() = default;
+
+  explicit Initializer(channel::Options) {}
+
+ protected:
+  auto allow_sessions() -> void {}
+
+  [[nodiscard]] auto uses_channel() const -> bool { return false; }
+
+  auto set_reporter(std::unique_ptr<cplib::interactor::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
+  }
+
+  auto set_user_fileno(int from_user_fd, int to_user_fd, cplib::trace::Level trace_level)
+      -> void {
+    set_from_user_fileno(from_user_fd, trace_level);
+    set_to_user_fileno(to_user_fd);
+  }
+};
+}  // namespace interactor
+}  // namespace cplib_initializers::common
+#endif
+
+#if __has_include("../common/resource_usage.hpp")
+#include "../common/resource_usage.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_
+// Stand-in for common/resource_usage.hpp when this header is used on its own: no usage line.
+namespace cplib_initializers::common::resource_usage {
+inline auto line() -> std::optional<std::string> { return std::nullopt; }
+}  // namespace cplib_initializers::common::resource_usage
+#endif
+
 namespace cplib_initializers::kattis::interactor {
 
 constexpr int EXITCODE_JE = 1;
@@ -62,6 +110,13 @@ struct Reporter : cplib::interactor::Reporter {
         score(std::format("{}/{}", feedback_dir, FILENAME_SCORE), std::ios_base::binary) {}
 
   auto report(const Report &report) -> int override {
+    const auto exit_code = report_verdict(report);
+    if (const auto usage = common::resource_usage::line()) judge_error << *usage << '\n';
+    return exit_code;
+  }
+
+ private:
+  auto report_verdict(const Report &report) -> int {
     switch (report.status) {
       case Status::INTERNAL_ERROR:
         judge_error << "FAIL " << report.message << '\n';
@@ -82,7 +137,6 @@ struct Reporter : cplib::interactor::Reporter {
     }
   }
 
- private:
   std::ofstream judge_message, judge_error, score;
 };
 
@@ -103,12 +157,12 @@ inline auto print_help_message(std::string_view program_name) -> void {
 }
 }  // namespace detail
 
-struct Initializer : cplib::interactor::Initializer {
-  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
+struct Initializer : common::interactor::Initializer {
+  using common::interactor::Initializer::Initializer;
 
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
     // Use PlainTextReporter to handle errors during the init process
-    state.reporter = std::make_unique<cplib::interactor::PlainTextReporter>();
+    set_reporter(std::make_unique<cplib::interactor::PlainTextReporter>());
 
     auto parsed_args = cplib::cmd_args::ParsedArgs(args);
 
@@ -128,13 +182,12 @@ struct Initializer : cplib::interactor::Initializer {
       cplib::panic(feedback_dir + " is not a directory");
     }
 
-    state.reporter = std::make_unique<Reporter>(feedback_dir);
+    set_reporter(std::make_unique<Reporter>(feedback_dir));
 
     signal(SIGPIPE, SIG_IGN);
 
     set_inf_path(inf, cplib::trace::Level::NONE);
-    set_from_user_fileno(fileno(stdin), cplib::trace::Level::NONE);
-    set_to_user_fileno(fileno(stdout));
+    set_user_fileno(fileno(stdin), fileno(stdout), cplib::trace::Level::NONE);
   }
 };
 }  // namespace cplib_initializers::kattis::interactor
@@ -16,7 +16,16 @@
 #ifndef CPLIB_INITIALIZERS_LUOGU_CHECKER_GRADER_INTERACTION_HPP_
 #define CPLIB_INITIALIZERS_LUOGU_CHECKER_GRADER_INTERACTION_HPP_
 
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <csignal>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
@@ -32,10 +41,48 @@
 #include <streambuf>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 
+#if __has_include("../common/checker.hpp")
+#include "../common/checker.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_
+// Stand-in for common/checker.hpp when this header is used on its own: the whole output is read,
+// with no output limit, early exit or profile.
+namespace cplib_initializers::common::checker {
+template <class Status>
+constexpr auto counts_as_accepted(Status status, double score) -> bool {
+  return status == Status::ACCEPTED || score == 1.0;
+}
+
+inline auto early_exit() -> bool { return false; }
+
+inline auto quit_unless_accepted(const cplib::evaluate::Result &result)
+    -> const cplib::evaluate::Result & {
+  return result;
+}
+
+struct Options {};
+
+struct Initializer : cplib::checker::Initializer {
+  Initializer() = default;
+
+  explicit Initializer(Options) {}
+
+ protected:
+  auto enable_early_exit(bool) -> void {}
+
+  auto set_reporter(std::unique_ptr<cplib::checker::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
+  }
+};
+}  // namespace cplib_initializers::common::checker
+#endif
+
 namespace cplib_initializers::luogu::checker_grader_interaction {
 
 namespace detail {
@@ -66,6 +113,69 @@ inline auto xml_escape(std::string_view s) -> std::string {
   }
   return buf.str();
 }
+
+// Copy the rest of `in_fd` to `out_fd` through a fixed-size buffer, for descriptors `sendfile`
+// cannot handle.
+inline auto copy_chunked(int in_fd, int out_fd) -> bool {
+  std::vector<char> buffer(1 << 16);
+  while (true) {
+    auto size = read(in_fd, buffer.data(), buffer.size());
+    if (size < 0 && errno == EINTR) continue;
+    if (size <= 0) return size == 0;
+    for (ssize_t written = 0; written < size;) {
+      auto result = write(out_fd, buffer.data() + written, size - written);
+      if (result < 0 && errno == EINTR) continue;
+      if (result < 0) return false;
+      written += result;
+    }
+  }
+}
+
+// Copy `in_fd` from its current offset to `out_fd` with constant memory. The kernel copies the
+// data with `sendfile` where it can.
+inline auto send_input(int in_fd, int out_fd) -> bool {
+  struct stat info{};
+  if (fstat(in_fd, &info) != 0) return false;
+  auto remaining = static_cast<std::size_t>(info.st_size);
+  while (remaining > 0) {
+    auto sent = sendfile(out_fd, in_fd, nullptr, std::min<std::size_t>(remaining, 1 << 30));
+    if (sent < 0 && errno == EINTR) continue;
+    if (sent < 0 && (errno == EINVAL || errno == ENOSYS)) break;
+    if (sent < 0) return false;
+    if (sent == 0) break;
+    remaining -= static_cast<std::size_t>(sent);
+  }
+  // Whatever `sendfile` left, including data appended since `fstat`, is copied by hand.
+  return copy_chunked(in_fd, out_fd);
+}
+
+inline auto open_input(const std::string &path) -> int {
+  const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) cplib::panic(std::string("Error opening input file: ") + std::strerror(errno));
+  return fd;
+}
+
+// `errno` of a failed `start_piping_file` copy, or 0.
+inline std::atomic<int> piping_error{0};
+
+/**
+ * Copy the file at `path` to `out_fd` on a helper thread, so that the program's output is read
+ * while its input is still being sent. A program that stops reading its input only ends the
+ * copy; the verdict is decided by its output. Any other failure is left in `piping_error`.
+ */
+inline auto start_piping_file(const std::string &path, int out_fd) -> void {
+  const auto in_fd = open_input(path);
+  std::thread([in_fd, out_fd] {
+    // `SIGPIPE` is sent to the writing thread, so blocking it here turns a closed pipe into
+    // `EPIPE` without affecting the checker.
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+    if (!send_input(in_fd, out_fd) && errno != EPIPE) piping_error = errno != 0 ? errno : EIO;
+    close(in_fd);
+  }).detach();
+}
 }  // namespace detail
 
 enum struct ExitCode : std::uint8_t {
@@ -97,6 +207,17 @@ struct Reporter : cplib::checker::Reporter {
   auto print_score(double score) -> void { stream << score; }
 
   auto report(const Report &report) -> int override {
+    // The program was judged on partial input if sending the rest failed.
+    if (const auto error = detail::piping_error.load(); error != 0) {
+      return report_verdict({Status::INTERNAL_ERROR, 0.0,
+                             std::format("Failed to write the input file to stdout: {}",
+                                         std::strerror(error))});
+    }
+    return report_verdict(report);
+  }
+
+ private:
+  auto report_verdict(const Report &report) -> int {
     stream << std::fixed << std::setprecision(9);
 
     if (appes_mode) {
@@ -186,12 +307,12 @@ inline auto print_help_message(std::string_view program_name) -> void {
 }
 }  // namespace detail
 
-struct Initializer : cplib::checker::Initializer {
-  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
+struct Initializer : common::checker::Initializer {
+  using common::checker::Initializer::Initializer;
 
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
     // Use PlainTextReporter to handle errors during the init process
-    state.reporter = std::make_unique<cplib::checker::PlainTextReporter>();
+    set_reporter(std::make_unique<cplib::checker::PlainTextReporter>());
 
     auto parsed_args = cplib::cmd_args::ParsedArgs(args);
 
@@ -204,34 +325,9 @@ struct Initializer : cplib::checker::Initializer {
                    std::string(detail::ARGS_USAGE));
     }
 
-    // Pipe all content in input file to stdout.
-    {
-      auto file = std::fopen(parsed_args.ordered[0].c_str(), "rb");
-      if (file == nullptr) {
-        cplib::panic(std::string("Error opening input file: ") + std::strerror(errno));
-      }
-      if (std::fseek(file, 0, SEEK_END) != 0) {
-        cplib::panic(std::string("Error seeking to end of file: ") + std::strerror(errno));
-      }
-      auto input_file_size = std::ftell(file);
-      if (input_file_size == -1) {
-        cplib::panic(std::string("Error getting input file size: ") + std::strerror(errno));
-      }
-      if (std::fseek(file, 0, SEEK_SET) != 0) {
-        cplib::panic(std::string("Error seeking to start of file: ") + std::strerror(errno));
-      }
-      std::vector<char> buffer(input_file_size);
-      if (std::fread(buffer.data(), 1, input_file_size, file) !=
-          static_cast<std::size_t>(input_file_size)) {
-        cplib::panic("Failed to read the entire input file");
-      }
-      std::fclose(file);
-      if (std::fwrite(buffer.data(), 1, input_file_size, stdout) !=
-          static_cast<std::size_t>(input_file_size)) {
-        cplib::panic("Failed to write the input file to stdout");
-      }
-      std::fflush(stdout);
-    }
+    // Pipe all content in input file to stdout, while the output is read from stdin.
+    std::fflush(stdout);
+    detail::start_piping_file(parsed_args.ordered[0], fileno(stdout));
 
     set_inf_path(parsed_args.ordered[0], cplib::trace::Level::NONE);
     set_ouf_fileno(fileno(stdin), cplib::trace::Level::NONE);
@@ -251,7 +347,7 @@ struct Initializer : cplib::checker::Initializer {
       }
     }
 
-    state.reporter = std::make_unique<Reporter>(report_file, appes_mode);
+    set_reporter(std::make_unique<Reporter>(report_file, appes_mode));
   }
 };
 }  // namespace cplib_initializers::luogu::checker_grader_interaction
@@ -20,20 +20,104 @@
  *
  * WARNING: Nowcoder does not support returning PARTIALLY_CORRECT, so all PARTIALLY_CORRECTs without
  * full score are considered WRONG_ANSWER.
+ *
+ * Since only ACCEPTED is told apart from anything else, the initializer enables early exit by
+ * default, see `early_exit`.
  */
 
 #ifndef CPLIB_INITIALIZERS_NOWCODER_CHECKER_HPP_
 #define CPLIB_INITIALIZERS_NOWCODER_CHECKER_HPP_
 
+#include <fcntl.h>
+
+#include <cerrno>
+#include <concepts>
 #include <cstdint>
+#include <cstring>
 #include <format>
+#include <fstream>
+#include <ios>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 
+#if __has_include("../common/checker.hpp")
+#include "../common/checker.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_
+// Stand-in for common/checker.hpp when this header is used on its own: the whole output is read,
+// with no output limit, early exit or profile.
+namespace cplib_initializers::common::checker {
+template <class Status>
+constexpr auto counts_as_accepted(Status status, double score) -> bool {
+  return status == Status::ACCEPTED || score == 1.0;
+}
+
+inline auto early_exit() -> bool { return false; }
+
+inline auto quit_unless_accepted(const cplib::evaluate::Result &result)
+    -> const cplib::evaluate::Result & {
+  return result;
+}
+
+struct Options {};
+
+struct Initializer : cplib::checker::Initializer {
+  Initializer() = default;
+
+  explicit Initializer(Options) {}
+
+ protected:
+  auto enable_early_exit(bool) -> void {}
+
+  auto set_reporter(std::unique_ptr<cplib::checker::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
+  }
+};
+}  // namespace cplib_initializers::common::checker
+#endif
+
+#if __has_include("../common/root.hpp")
+#include "../common/root.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_ROOT_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_ROOT_HPP_
+// Stand-in for common/root.hpp when this header is used on its own: files are resolved against
+// the working directory.
+namespace cplib_initializers::common::root {
+class Root {
+ public:
+  Root() = default;
+
+  explicit Root(const cplib::cmd_args::ParsedArgs &parsed_args) {
+    if (parsed_args.vars.contains("root") || parsed_args.vars.contains("root-fd")) {
+      cplib::panic("--root and --root-fd need common/root.hpp next to this header");
+    }
+  }
+
+  [[nodiscard]] auto open(std::string_view name, int flags = O_RDONLY) const -> int {
+    const auto fd = ::open(std::string(name).c_str(), flags | O_CLOEXEC);
+    if (fd < 0) cplib::panic(std::format("Failed to open {}: {}", name, std::strerror(errno)));
+    return fd;
+  }
+
+  [[nodiscard]] auto try_write(std::string_view name, std::string_view content) const -> bool {
+    std::ofstream stream(std::string(name), std::ios_base::binary);
+    stream << content;
+    stream.flush();
+    return static_cast<bool>(stream);
+  }
+
+  auto write(std::string_view name, std::string_view content) const -> void {
+    if (!try_write(name, content)) cplib::panic(std::format("Failed to write {}", name));
+  }
+};
+}  // namespace cplib_initializers::common::root
+#endif
+
 namespace cplib_initializers::nowcoder::checker {
 
 constexpr std::string_view FILENAME_INF = "input";
@@ -50,7 +134,7 @@ struct Reporter : cplib::checker::Reporter {
   using Status = Report::Status;
 
   auto report(const Report &report) -> int override {
-    if (report.status == Status::ACCEPTED || report.score == 1.0) {
+    if (common::checker::counts_as_accepted(report.status, report.score)) {
       return static_cast<int>(ExitCode::ACCEPTED);
     }
 
@@ -58,8 +142,11 @@ struct Reporter : cplib::checker::Reporter {
   }
 };
 
+using common::checker::early_exit;
+using common::checker::quit_unless_accepted;
+
 namespace detail {
-constexpr std::string_view ARGS_USAGE = "[...]";
+constexpr std::string_view ARGS_USAGE = "[--root=<dir> | --root-fd=<fd>] [...]";
 
 inline auto print_help_message(std::string_view program_name) -> void {
   std::string msg = std::format(CPLIB_STARTUP_TEXT
@@ -75,13 +162,21 @@ inline auto print_help_message(std::string_view program_name) -> void {
 }
 }  // namespace detail
 
-struct Initializer : cplib::checker::Initializer {
-  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
+struct Initializer : common::checker::Initializer {
+  bool early_exit = true;
 
+  Initializer() = default;
+
+  explicit Initializer(common::checker::Options options) : common::checker::Initializer(options) {}
+
+  // Only a `bool` selects this overload, so that e.g. `Initializer(1 << 20)` does not compile.
+  explicit Initializer(std::same_as<bool> auto early_exit, common::checker::Options options = {})
+      : common::checker::Initializer(options), early_exit(early_exit) {}
+
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
     // Nowcoder's reporter does not have any ability to report error information, so use
     // PlainTextReporter to handle the error exit during init to provide clearer information.
-    state.reporter = std::make_unique<cplib::checker::PlainTextReporter>();
+    set_reporter(std::make_unique<cplib::checker::PlainTextReporter>());
 
     auto parsed_args = cplib::cmd_args::ParsedArgs(args);
 
@@ -89,12 +184,14 @@ struct Initializer : cplib::checker::Initializer {
       detail::print_help_message(arg0);
     }
 
-    set_inf_path(FILENAME_INF, cplib::trace::Level::NONE);
-    set_ouf_path(FILENAME_OUF, cplib::trace::Level::NONE);
-    set_ans_path(FILENAME_ANS, cplib::trace::Level::NONE);
+    const common::root::Root root(parsed_args);
+    set_inf_fileno(root.open(FILENAME_INF), cplib::trace::Level::NONE);
+    set_ouf_fileno(root.open(FILENAME_OUF), cplib::trace::Level::NONE);
+    set_ans_fileno(root.open(FILENAME_ANS), cplib::trace::Level::NONE);
     set_evaluator(cplib::trace::Level::NONE);
 
-    state.reporter = std::make_unique<Reporter>();
+    set_reporter(std::make_unique<Reporter>());
+    enable_early_exit(early_exit);
   }
 };
 }  // namespace cplib_initializers::nowcoder::checker
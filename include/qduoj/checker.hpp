@@ -23,20 +23,61 @@
 
  * WARNING: QDUOJ checker does not provide an answer file when running, so trying to call methods on
  * chk.ans will lead to undefined behavior.
+ *
+ * Since only ACCEPTED is told apart from anything else, the initializer enables early exit by
+ * default, see `early_exit`.
  */
 
 #ifndef CPLIB_INITIALIZERS_QDUOJ_CHECKER_HPP_
 #define CPLIB_INITIALIZERS_QDUOJ_CHECKER_HPP_
 
+#include <concepts>
 #include <cstdint>
 #include <format>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 
+#if __has_include("../common/checker.hpp")
+#include "../common/checker.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_
+// Stand-in for common/checker.hpp when this header is used on its own: the whole output is read,
+// with no output limit, early exit or profile.
+namespace cplib_initializers::common::checker {
+template <class Status>
+constexpr auto counts_as_accepted(Status status, double score) -> bool {
+  return status == Status::ACCEPTED || score == 1.0;
+}
+
+inline auto early_exit() -> bool { return false; }
+
+inline auto quit_unless_accepted(const cplib::evaluate::Result &result)
+    -> const cplib::evaluate::Result & {
+  return result;
+}
+
+struct Options {};
+
+struct Initializer : cplib::checker::Initializer {
+  Initializer() = default;
+
+  explicit Initializer(Options) {}
+
+ protected:
+  auto enable_early_exit(bool) -> void {}
+
+  auto set_reporter(std::unique_ptr<cplib::checker::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
+  }
+};
+}  // namespace cplib_initializers::common::checker
+#endif
+
 namespace cplib_initializers::qduoj::checker {
 
 enum struct ExitCode : std::int8_t {
@@ -52,7 +93,7 @@ struct Reporter : cplib::checker::Reporter {
   auto report(const Report &report) -> int override {
     if (report.status == Status::INTERNAL_ERROR) {
       return static_cast<int>(ExitCode::INTERNAL_ERROR);
-    } else if (report.status == Status::ACCEPTED || report.score == 1.0) {
+    } else if (common::checker::counts_as_accepted(report.status, report.score)) {
       return static_cast<int>(ExitCode::ACCEPTED);
     } else {
       return static_cast<int>(ExitCode::WRONG_ANSWER);
@@ -60,6 +101,9 @@ struct Reporter : cplib::checker::Reporter {
   }
 };
 
+using common::checker::early_exit;
+using common::checker::quit_unless_accepted;
+
 namespace detail {
 constexpr std::string_view ARGS_USAGE = "<input_file> <output_file> [...]";
 
@@ -77,13 +121,21 @@ inline auto print_help_message(std::string_view program_name) -> void {
 }
 }  // namespace detail
 
-struct Initializer : cplib::checker::Initializer {
-  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
+struct Initializer : common::checker::Initializer {
+  bool early_exit = true;
+
+  Initializer() = default;
+
+  explicit Initializer(common::checker::Options options) : common::checker::Initializer(options) {}
 
+  // Only a `bool` selects this overload, so that e.g. `Initializer(1 << 20)` does not compile.
+  explicit Initializer(std::same_as<bool> auto early_exit, common::checker::Options options = {})
+      : common::checker::Initializer(options), early_exit(early_exit) {}
+
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
     // QDUOJ's reporter does not have any ability to report error information, so use
     // PlainTextReporter to handle the error exit during init to provide clearer information.
-    state.reporter = std::make_unique<cplib::checker::PlainTextReporter>();
+    set_reporter(std::make_unique<cplib::checker::PlainTextReporter>());
 
     auto parsed_args = cplib::cmd_args::ParsedArgs(args);
 
@@ -103,7 +155,8 @@ struct Initializer : cplib::checker::Initializer {
     set_ouf_path(ouf, cplib::trace::Level::NONE);
     set_evaluator(cplib::trace::Level::NONE);
 
-    state.reporter = std::make_unique<Reporter>();
+    set_reporter(std::make_unique<Reporter>());
+    enable_early_exit(early_exit);
   }
 };
 }  // namespace cplib_initializers::qduoj::checker
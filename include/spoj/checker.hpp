@@ -16,21 +16,85 @@
 #ifndef CPLIB_INITIALIZERS_SPOJ_CHECKER_HPP_
 #define CPLIB_INITIALIZERS_SPOJ_CHECKER_HPP_
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
 #include <cmath>
+#include <cstddef>
+#include <concepts>
 #include <format>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <streambuf>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 #include "spoj.h"
 
+#if __has_include("../common/checker.hpp")
+#include "../common/checker.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_
+// Stand-in for common/checker.hpp when this header is used on its own: the whole output is read,
+// with no output limit, early exit or profile.
+namespace cplib_initializers::common::checker {
+template <class Status>
+constexpr auto counts_as_accepted(Status status, double score) -> bool {
+  return status == Status::ACCEPTED || score == 1.0;
+}
+
+inline auto early_exit() -> bool { return false; }
+
+inline auto quit_unless_accepted(const cplib::evaluate::Result &result)
+    -> const cplib::evaluate::Result & {
+  return result;
+}
+
+struct Options {};
+
+struct Initializer : cplib::checker::Initializer {
+  Initializer() = default;
+
+  explicit Initializer(Options) {}
+
+ protected:
+  auto enable_early_exit(bool) -> void {}
+
+  auto set_reporter(std::unique_ptr<cplib::checker::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
+  }
+};
+}  // namespace cplib_initializers::common::checker
+#endif
+
+#if __has_include("../common/resource_usage.hpp")
+#include "../common/resource_usage.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_
+// Stand-in for common/resource_usage.hpp when this header is used on its own: no usage line.
+namespace cplib_initializers::common::resource_usage {
+inline auto line() -> std::optional<std::string> { return std::nullopt; }
+}  // namespace cplib_initializers::common::resource_usage
+#endif
+
 namespace cplib_initializers::spoj::checker {
 
+/// The tested program's source, as passed on `SPOJ_T_SRC_FD`.
+struct Source {
+  // Size in bytes.
+  std::size_t length;
+  // Number of occurrences of each byte value, if requested from the initializer.
+  std::optional<std::array<std::size_t, 256>> histogram;
+};
+
 struct Reporter : cplib::checker::Reporter {
   using Report = cplib::checker::Report;
   using Status = Report::Status;
@@ -68,6 +132,8 @@ struct Reporter : cplib::checker::Reporter {
       }
     }
 
+    if (const auto usage = common::resource_usage::line()) message << '\n' << *usage << '\n';
+
     switch (report.status) {
       case Status::INTERNAL_ERROR:
         return SPOJ_RV_IE;
@@ -98,13 +164,81 @@ inline auto print_help_message(std::string_view program_name) -> void {
                                 program_name, ARGS_USAGE);
   cplib::panic(msg);
 }
+
+inline bool source_histogram = false;
+inline std::optional<Source> source;
+
+// Bytes left to read on `fd`, which is consumed unless it is a regular file.
+inline auto measure_length(int fd) -> std::size_t {
+  struct stat info{};
+  if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+    const auto offset = lseek(fd, 0, SEEK_CUR);
+    if (offset >= 0 && offset <= info.st_size) {
+      return static_cast<std::size_t>(info.st_size - offset);
+    }
+  }
+
+  std::size_t length = 0;
+  ssize_t moved;
+  // A pipe is drained into `/dev/null` by the kernel.
+  if (const auto null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC); null_fd >= 0) {
+    while ((moved = splice(fd, nullptr, null_fd, nullptr, 1 << 20, SPLICE_F_MOVE)) > 0 ||
+           (moved < 0 && errno == EINTR)) {
+      if (moved > 0) length += static_cast<std::size_t>(moved);
+    }
+    close(null_fd);
+    if (moved == 0) return length;
+  }
+
+  std::vector<char> buffer(1 << 16);
+  while ((moved = read(fd, buffer.data(), buffer.size())) > 0 || (moved < 0 && errno == EINTR)) {
+    if (moved > 0) length += static_cast<std::size_t>(moved);
+  }
+  return length;
+}
+
+// Read `fd` through a fixed-size buffer, counting each byte value.
+inline auto measure_histogram(int fd) -> Source {
+  Source source{0, std::array<std::size_t, 256>{}};
+  std::vector<unsigned char> buffer(1 << 16);
+  ssize_t size;
+  while ((size = read(fd, buffer.data(), buffer.size())) > 0 || (size < 0 && errno == EINTR)) {
+    for (ssize_t i = 0; i < size; ++i) ++(*source.histogram)[buffer[i]];
+    if (size > 0) source.length += static_cast<std::size_t>(size);
+  }
+  return source;
+}
 }  // namespace detail
 
-struct Initializer : cplib::checker::Initializer {
-  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
+/**
+ * The tested program's source, e.g. for scoring code-golf problems in the evaluator. Measured on
+ * first use without keeping the source in memory: with `fstat` for a file, by draining a pipe
+ * into `/dev/null`, or by counting bytes in chunks when a histogram is requested.
+ */
+inline auto source() -> const Source & {
+  if (!detail::source.has_value()) {
+    detail::source = detail::source_histogram
+                         ? detail::measure_histogram(SPOJ_T_SRC_FD)
+                         : Source{detail::measure_length(SPOJ_T_SRC_FD), std::nullopt};
+  }
+  return *detail::source;
+}
+
+struct Initializer : common::checker::Initializer {
+  // Count byte values of the source as well, see `source()`.
+  bool source_histogram = false;
 
-    state.reporter = std::make_unique<Reporter>();
+  Initializer() = default;
+
+  explicit Initializer(common::checker::Options options) : common::checker::Initializer(options) {}
+
+  // Only a `bool` selects this overload, so that e.g. `Initializer(1 << 20)` does not compile.
+  explicit Initializer(std::same_as<bool> auto source_histogram,
+                       common::checker::Options options = {})
+      : common::checker::Initializer(options), source_histogram(source_histogram) {}
+
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
+    set_reporter(std::make_unique<Reporter>());
 
     spoj_init();
 
@@ -118,6 +252,8 @@ struct Initializer : cplib::checker::Initializer {
     set_ouf_fileno(SPOJ_T_OUT_FD, cplib::trace::Level::STACK_ONLY);
     set_ans_fileno(SPOJ_P_OUT_FD, cplib::trace::Level::STACK_ONLY);
     set_evaluator(cplib::trace::Level::STACK_ONLY);
+
+    detail::source_histogram = source_histogram;
   }
 };
 
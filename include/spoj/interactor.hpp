@@ -20,15 +20,63 @@
 #include <format>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <streambuf>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 #include "spoj/spoj_interactive.h"
 
+#if __has_include("../common/interactor.hpp")
+#include "../common/interactor.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_
+// Stand-in for common/interactor.hpp when this header is used on its own: the contestant is
+// connected through cplib's own streams, with no contestant channel or profile.
+namespace cplib_initializers::common {
+namespace channel {
+struct Options {};
+}  // namespace channel
+
+namespace interactor {
+struct Initializer : cplib::interactor::Initializer {
+  Initializer() = default;
+
+  explicit Initializer(channel::Options) {}
+
+ protected:
+  auto allow_sessions() -> void {}
+
+  [[nodiscard]] auto uses_channel() const -> bool { return false; }
+
+  auto set_reporter(std::unique_ptr<cplib::interactor::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
+  }
+
+  auto set_user_fileno(int from_user_fd, int to_user_fd, cplib::trace::Level trace_level)
+      -> void {
+    set_from_user_fileno(from_user_fd, trace_level);
+    set_to_user_fileno(to_user_fd);
+  }
+};
+}  // namespace interactor
+}  // namespace cplib_initializers::common
+#endif
+
+#if __has_include("../common/resource_usage.hpp")
+#include "../common/resource_usage.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_
+// Stand-in for common/resource_usage.hpp when this header is used on its own: no usage line.
+namespace cplib_initializers::common::resource_usage {
+inline auto line() -> std::optional<std::string> { return std::nullopt; }
+}  // namespace cplib_initializers::common::resource_usage
+#endif
+
 namespace cplib_initializers::spoj::interactor {
 
 struct Reporter : cplib::interactor::Reporter {
@@ -61,6 +109,8 @@ struct Reporter : cplib::interactor::Reporter {
       }
     }
 
+    if (const auto usage = common::resource_usage::line()) message << '\n' << *usage << '\n';
+
     switch (report.status) {
       case Status::INTERNAL_ERROR:
         return SPOJ_RV_SE;
@@ -93,11 +143,11 @@ inline auto print_help_message(std::string_view program_name) -> void {
 }
 }  // namespace detail
 
-struct Initializer : cplib::interactor::Initializer {
-  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
+struct Initializer : common::interactor::Initializer {
+  using common::interactor::Initializer::Initializer;
 
-    state.reporter = std::make_unique<Reporter>();
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
+    set_reporter(std::make_unique<Reporter>());
 
     spoj_init();
 
@@ -108,8 +158,8 @@ struct Initializer : cplib::interactor::Initializer {
     }
 
     set_inf_fileno(SPOJ_P_IN_FD, cplib::trace::Level::STACK_ONLY);
-    set_from_user_fileno(SPOJ_T_OUT_FD, cplib::trace::Level::STACK_ONLY);
-    set_to_user_fileno(SPOJ_FOR_TESTED_FD);
+    // spoj_init() closes SPOJ_FOR_TESTED_FD at exit, so the channel must be installed after it.
+    set_user_fileno(SPOJ_T_OUT_FD, SPOJ_FOR_TESTED_FD, cplib::trace::Level::STACK_ONLY);
   }
 };
 
@@ -1,11 +1,18 @@
 #ifndef __SPOJ_INTERACTIVE_H__
 #define __SPOJ_INTERACTIVE_H__
 
+/* Define SPOJ_INTERACTIVE_FAST before including this header for a high-throughput mode:
+   spoj_printf output is fully buffered and flushed before each spoj_scanf instead of after each
+   line, the tested program's output is read through a larger buffer, and spoj_srclen() measures
+   the source without copying it into the process. */
+
 #include <errno.h>
+#include <fcntl.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 /* return values */
@@ -45,9 +52,27 @@ FILE* spoj_for_tested; /* data for tested program */
     if (!(x)) exit(SPOJ_RV_WA); \
   }
 
+/* buffer size of the tested program's channels in fast mode */
+#ifndef SPOJ_FAST_BUF_SIZE
+#define SPOJ_FAST_BUF_SIZE (1 << 16)
+#endif
+
+/* in fast mode, the tested program gets pending data before it is expected to answer */
+#ifdef SPOJ_INTERACTIVE_FAST
+#define __SPOJ_FLUSH_FOR_TESTED()                          \
+  do {                                                     \
+    if (fflush(spoj_for_tested) == EOF) exit(SPOJ_RV_EOF); \
+  } while (0)
+#else
+#define __SPOJ_FLUSH_FOR_TESTED() \
+  do {                            \
+  } while (0)
+#endif
+
 /* spoj_scanf() - ... */
 #define spoj_scanf(t, z)                    \
   {                                         \
+    __SPOJ_FLUSH_FOR_TESTED();              \
     int ret = fscanf(spoj_t_out, (t), (z)); \
     if (ret == EOF) exit(SPOJ_RV_EOF);      \
     if (ret != 1) exit(SPOJ_RV_WA);         \
@@ -62,6 +87,7 @@ FILE* spoj_for_tested; /* data for tested program */
 
 #define __BUF_SIZE 1024
 
+#ifndef SPOJ_INTERACTIVE_FAST
 unsigned spoj_srclen() {
   char buffer[__BUF_SIZE];
   unsigned size = 0;
@@ -69,6 +95,42 @@ unsigned spoj_srclen() {
   while ((temp = read(SPOJ_T_SRC_FD, buffer, __BUF_SIZE)) > 0) size += temp;
   return size;
 }
+#else
+/* like the above, the source is consumed: a file is measured with fstat and skipped, a pipe is
+   drained into /dev/null by the kernel, falling back to reads in big chunks */
+unsigned spoj_srclen() {
+  static char buffer[SPOJ_FAST_BUF_SIZE];
+  unsigned size = 0;
+  ssize_t temp;
+  struct stat info;
+  off_t offset;
+
+  if (fstat(SPOJ_T_SRC_FD, &info) == 0 && S_ISREG(info.st_mode) &&
+      (offset = lseek(SPOJ_T_SRC_FD, 0, SEEK_CUR)) >= 0 && offset <= info.st_size) {
+    lseek(SPOJ_T_SRC_FD, 0, SEEK_END);
+    return (unsigned)(info.st_size - offset);
+  }
+
+#ifdef SPLICE_F_MOVE
+  {
+    int null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (null_fd >= 0) {
+      while ((temp = splice(SPOJ_T_SRC_FD, NULL, null_fd, NULL, 1 << 20, SPLICE_F_MOVE)) > 0 ||
+             (temp < 0 && errno == EINTR)) {
+        if (temp > 0) size += (unsigned)temp;
+      }
+      close(null_fd);
+      if (temp == 0) return size;
+    }
+  }
+#endif
+
+  while ((temp = read(SPOJ_T_SRC_FD, buffer, sizeof(buffer))) > 0 || (temp < 0 && errno == EINTR)) {
+    if (temp > 0) size += (unsigned)temp;
+  }
+  return size;
+}
+#endif
 
 /* ... */
 static void spoj_finalize() {
@@ -96,7 +158,18 @@ void spoj_init() {
   __WARN_IF_NULL(spoj_u_info = fdopen(SPOJ_U_INFO_FD, "w"));
   __WARN_IF_NULL(spoj_for_tested = fdopen(SPOJ_FOR_TESTED_FD, "w"));
 
+#ifdef SPOJ_INTERACTIVE_FAST
+  {
+    /* glibc ignores the size unless a buffer is given */
+    static char for_tested_buffer[SPOJ_FAST_BUF_SIZE];
+    static char t_out_buffer[SPOJ_FAST_BUF_SIZE];
+    if (spoj_for_tested != NULL)
+      setvbuf(spoj_for_tested, for_tested_buffer, _IOFBF, SPOJ_FAST_BUF_SIZE);
+    if (spoj_t_out != NULL) setvbuf(spoj_t_out, t_out_buffer, _IOFBF, SPOJ_FAST_BUF_SIZE);
+  }
+#else
   setlinebuf(spoj_for_tested);
+#endif
 
   signal(SIGPIPE, SIG_IGN);
 
@@ -16,17 +16,96 @@
 #ifndef CPLIB_INITIALIZERS_SYZOJ_CHECKER_HPP_
 #define CPLIB_INITIALIZERS_SYZOJ_CHECKER_HPP_
 
+#include <fcntl.h>
+
+#include <cerrno>
+#include <cstring>
 #include <format>
+#include <fstream>
 #include <iomanip>
 #include <ios>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 
+#if __has_include("../common/checker.hpp")
+#include "../common/checker.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_
+// Stand-in for common/checker.hpp when this header is used on its own: the whole output is read,
+// with no output limit, early exit or profile.
+namespace cplib_initializers::common::checker {
+template <class Status>
+constexpr auto counts_as_accepted(Status status, double score) -> bool {
+  return status == Status::ACCEPTED || score == 1.0;
+}
+
+inline auto early_exit() -> bool { return false; }
+
+inline auto quit_unless_accepted(const cplib::evaluate::Result &result)
+    -> const cplib::evaluate::Result & {
+  return result;
+}
+
+struct Options {};
+
+struct Initializer : cplib::checker::Initializer {
+  Initializer() = default;
+
+  explicit Initializer(Options) {}
+
+ protected:
+  auto enable_early_exit(bool) -> void {}
+
+  auto set_reporter(std::unique_ptr<cplib::checker::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
+  }
+};
+}  // namespace cplib_initializers::common::checker
+#endif
+
+#if __has_include("../common/root.hpp")
+#include "../common/root.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_ROOT_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_ROOT_HPP_
+// Stand-in for common/root.hpp when this header is used on its own: files are resolved against
+// the working directory.
+namespace cplib_initializers::common::root {
+class Root {
+ public:
+  Root() = default;
+
+  explicit Root(const cplib::cmd_args::ParsedArgs &parsed_args) {
+    if (parsed_args.vars.contains("root") || parsed_args.vars.contains("root-fd")) {
+      cplib::panic("--root and --root-fd need common/root.hpp next to this header");
+    }
+  }
+
+  [[nodiscard]] auto open(std::string_view name, int flags = O_RDONLY) const -> int {
+    const auto fd = ::open(std::string(name).c_str(), flags | O_CLOEXEC);
+    if (fd < 0) cplib::panic(std::format("Failed to open {}: {}", name, std::strerror(errno)));
+    return fd;
+  }
+
+  [[nodiscard]] auto try_write(std::string_view name, std::string_view content) const -> bool {
+    std::ofstream stream(std::string(name), std::ios_base::binary);
+    stream << content;
+    stream.flush();
+    return static_cast<bool>(stream);
+  }
+
+  auto write(std::string_view name, std::string_view content) const -> void {
+    if (!try_write(name, content)) cplib::panic(std::format("Failed to write {}", name));
+  }
+};
+}  // namespace cplib_initializers::common::root
+#endif
+
 namespace cplib_initializers::syzoj::checker {
 
 constexpr std::string_view FILENAME_INF = "input";
@@ -76,7 +155,7 @@ struct Reporter : cplib::checker::Reporter {
 };
 
 namespace detail {
-constexpr std::string_view ARGS_USAGE = "[...]";
+constexpr std::string_view ARGS_USAGE = "[--root=<dir> | --root-fd=<fd>] [...]";
 
 inline auto print_help_message(std::string_view program_name) -> void {
   std::string msg = std::format(CPLIB_STARTUP_TEXT
@@ -92,11 +171,11 @@ inline auto print_help_message(std::string_view program_name) -> void {
 }
 }  // namespace detail
 
-struct Initializer : cplib::checker::Initializer {
-  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
+struct Initializer : common::checker::Initializer {
+  using common::checker::Initializer::Initializer;
 
-    state.reporter = std::make_unique<Reporter>();
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
+    set_reporter(std::make_unique<Reporter>());
 
     auto parsed_args = cplib::cmd_args::ParsedArgs(args);
 
@@ -104,9 +183,10 @@ struct Initializer : cplib::checker::Initializer {
       detail::print_help_message(arg0);
     }
 
-    set_inf_path(FILENAME_INF, cplib::trace::Level::STACK_ONLY);
-    set_ouf_path(FILENAME_OUF, cplib::trace::Level::STACK_ONLY);
-    set_ans_path(FILENAME_ANS, cplib::trace::Level::STACK_ONLY);
+    const common::root::Root root(parsed_args);
+    set_inf_fileno(root.open(FILENAME_INF), cplib::trace::Level::STACK_ONLY);
+    set_ouf_fileno(root.open(FILENAME_OUF), cplib::trace::Level::STACK_ONLY);
+    set_ans_fileno(root.open(FILENAME_ANS), cplib::trace::Level::STACK_ONLY);
     set_evaluator(cplib::trace::Level::STACK_ONLY);
   }
 };
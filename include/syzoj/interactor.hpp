@@ -16,7 +16,11 @@
 #ifndef CPLIB_INITIALIZERS_SYZOJ_INTERACTOR_HPP_
 #define CPLIB_INITIALIZERS_SYZOJ_INTERACTOR_HPP_
 
+#include <fcntl.h>
+
+#include <cerrno>
 #include <csignal>
+#include <cstring>
 #include <format>
 #include <fstream>
 #include <iomanip>
@@ -25,10 +29,84 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 
+#if __has_include("../common/interactor.hpp")
+#include "../common/interactor.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_
+// Stand-in for common/interactor.hpp when this header is used on its own: the contestant is
+// connected through cplib's own streams, with no contestant channel or profile.
+namespace cplib_initializers::common {
+namespace channel {
+struct Options {};
+}  // namespace channel
+
+namespace interactor {
+struct Initializer : cplib::interactor::Initializer {
+  Initializer() = default;
+
+  explicit Initializer(channel::Options) {}
+
+ protected:
+  auto allow_sessions() -> void {}
+
+  [[nodiscard]] auto uses_channel() const -> bool { return false; }
+
+  auto set_reporter(std::unique_ptr<cplib::interactor::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
+  }
+
+  auto set_user_fileno(int from_user_fd, int to_user_fd, cplib::trace::Level trace_level)
+      -> void {
+    set_from_user_fileno(from_user_fd, trace_level);
+    set_to_user_fileno(to_user_fd);
+  }
+};
+}  // namespace interactor
+}  // namespace cplib_initializers::common
+#endif
+
+#if __has_include("../common/root.hpp")
+#include "../common/root.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_ROOT_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_ROOT_HPP_
+// Stand-in for common/root.hpp when this header is used on its own: files are resolved against
+// the working directory.
+namespace cplib_initializers::common::root {
+class Root {
+ public:
+  Root() = default;
+
+  explicit Root(const cplib::cmd_args::ParsedArgs &parsed_args) {
+    if (parsed_args.vars.contains("root") || parsed_args.vars.contains("root-fd")) {
+      cplib::panic("--root and --root-fd need common/root.hpp next to this header");
+    }
+  }
+
+  [[nodiscard]] auto open(std::string_view name, int flags = O_RDONLY) const -> int {
+    const auto fd = ::open(std::string(name).c_str(), flags | O_CLOEXEC);
+    if (fd < 0) cplib::panic(std::format("Failed to open {}: {}", name, std::strerror(errno)));
+    return fd;
+  }
+
+  [[nodiscard]] auto try_write(std::string_view name, std::string_view content) const -> bool {
+    std::ofstream stream(std::string(name), std::ios_base::binary);
+    stream << content;
+    stream.flush();
+    return static_cast<bool>(stream);
+  }
+
+  auto write(std::string_view name, std::string_view content) const -> void {
+    if (!try_write(name, content)) cplib::panic(std::format("Failed to write {}", name));
+  }
+};
+}  // namespace cplib_initializers::common::root
+#endif
+
 namespace cplib_initializers::syzoj::interactor {
 
 constexpr std::string_view FILENAME_INF = "input";
@@ -38,12 +116,13 @@ struct Reporter : cplib::interactor::Reporter {
   using Report = cplib::interactor::Report;
   using Status = Report::Status;
 
+  explicit Reporter(std::shared_ptr<const common::root::Root> root =
+                        std::make_shared<const common::root::Root>())
+      : root(std::move(root)) {}
+
   auto report(const Report &report) -> int override {
-    std::ofstream score(std::string(FILENAME_SCORE), std::ios_base::binary);
     std::ostream message(std::clog.rdbuf());
 
-    score << std::fixed << std::setprecision(9) << report.score * 100.0;
-
     message << std::fixed << std::setprecision(2) << report.status.to_string() << ", scores "
             << report.score * 100.0 << " of 100.\n";
 
@@ -61,18 +140,20 @@ struct Reporter : cplib::interactor::Reporter {
       }
     }
 
-    score.flush();
-    if (!score) {
+    if (!root->try_write(FILENAME_SCORE, std::format("{:.9f}", report.score * 100.0))) {
       message << "Failed to write " << FILENAME_SCORE << ".\n";
       return 1;
     }
 
     return 0;
   }
+
+ private:
+  std::shared_ptr<const common::root::Root> root;
 };
 
 namespace detail {
-constexpr std::string_view ARGS_USAGE = "[...]";
+constexpr std::string_view ARGS_USAGE = "[--root=<dir> | --root-fd=<fd>] [...]";
 
 inline auto print_help_message(std::string_view program_name) -> void {
   std::string msg = std::format(CPLIB_STARTUP_TEXT
@@ -88,11 +169,11 @@ inline auto print_help_message(std::string_view program_name) -> void {
 }
 }  // namespace detail
 
-struct Initializer : cplib::interactor::Initializer {
-  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
+struct Initializer : common::interactor::Initializer {
+  using common::interactor::Initializer::Initializer;
 
-    state.reporter = std::make_unique<Reporter>();
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
+    set_reporter(std::make_unique<Reporter>());
 
     auto parsed_args = cplib::cmd_args::ParsedArgs(args);
 
@@ -100,11 +181,13 @@ struct Initializer : cplib::interactor::Initializer {
       detail::print_help_message(arg0);
     }
 
+    const auto root = std::make_shared<const common::root::Root>(parsed_args);
+    set_reporter(std::make_unique<Reporter>(root));
+
     signal(SIGPIPE, SIG_IGN);
 
-    set_inf_path(FILENAME_INF, cplib::trace::Level::STACK_ONLY);
-    set_from_user_fileno(fileno(stdin), cplib::trace::Level::STACK_ONLY);
-    set_to_user_fileno(fileno(stdout));
+    set_inf_fileno(root->open(FILENAME_INF), cplib::trace::Level::STACK_ONLY);
+    set_user_fileno(fileno(stdin), fileno(stdout), cplib::trace::Level::STACK_ONLY);
   }
 };
 
@@ -31,10 +31,57 @@
 #include <streambuf>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 
+#if __has_include("../common/checker.hpp")
+#include "../common/checker.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_CHECKER_HPP_
+// Stand-in for common/checker.hpp when this header is used on its own: the whole output is read,
+// with no output limit, early exit or profile.
+namespace cplib_initializers::common::checker {
+template <class Status>
+constexpr auto counts_as_accepted(Status status, double score) -> bool {
+  return status == Status::ACCEPTED || score == 1.0;
+}
+
+inline auto early_exit() -> bool { return false; }
+
+inline auto quit_unless_accepted(const cplib::evaluate::Result &result)
+    -> const cplib::evaluate::Result & {
+  return result;
+}
+
+struct Options {};
+
+struct Initializer : cplib::checker::Initializer {
+  Initializer() = default;
+
+  explicit Initializer(Options) {}
+
+ protected:
+  auto enable_early_exit(bool) -> void {}
+
+  auto set_reporter(std::unique_ptr<cplib::checker::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
+  }
+};
+}  // namespace cplib_initializers::common::checker
+#endif
+
+#if __has_include("../common/resource_usage.hpp")
+#include "../common/resource_usage.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_
+// Stand-in for common/resource_usage.hpp when this header is used on its own: no usage line.
+namespace cplib_initializers::common::resource_usage {
+inline auto line() -> std::optional<std::string> { return std::nullopt; }
+}  // namespace cplib_initializers::common::resource_usage
+#endif
+
 namespace cplib_initializers::testlib::checker {
 
 namespace detail {
@@ -161,6 +208,11 @@ struct Reporter : cplib::checker::Reporter {
       stream << report.message << '\n';
     }
 
+    if (const auto usage = common::resource_usage::line()) {
+      // After the root element, an XML comment keeps the report well-formed.
+      stream << (appes_mode ? std::format("<!-- {} -->", *usage) : *usage) << '\n';
+    }
+
     switch (report.status) {
       case Status::INTERNAL_ERROR:
         return static_cast<int>(ExitCode::INTERNAL_ERROR);
@@ -195,16 +247,15 @@ inline auto print_help_message(std::string_view program_name) -> void {
 }
 }  // namespace detail
 
-struct Initializer : cplib::checker::Initializer {
+struct Initializer : common::checker::Initializer {
   bool percent_mode;
 
-  explicit Initializer(bool percent_mode) : percent_mode(percent_mode) {}
+  explicit Initializer(bool percent_mode, common::checker::Options options = {})
+      : common::checker::Initializer(options), percent_mode(percent_mode) {}
 
   auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
-
     // Use PlainTextReporter to handle errors during the init process
-    state.reporter = std::make_unique<cplib::checker::PlainTextReporter>();
+    set_reporter(std::make_unique<cplib::checker::PlainTextReporter>());
 
     auto parsed_args = cplib::cmd_args::ParsedArgs(args);
 
@@ -235,7 +286,7 @@ struct Initializer : cplib::checker::Initializer {
       }
     }
 
-    state.reporter = std::make_unique<Reporter>(report_file, appes_mode, percent_mode);
+    set_reporter(std::make_unique<Reporter>(report_file, appes_mode, percent_mode));
   }
 };
 }  // namespace cplib_initializers::testlib::checker
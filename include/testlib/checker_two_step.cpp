@@ -20,24 +20,51 @@
  * interactor_two_step.hpp.
  *
  * See two_step_interaction_help.md for details.
+ *
+ * If the interactor attaches its transcript, a header named `checker_two_step_hook.hpp` on the
+ * include path can define
+ *
+ *     auto evaluate_transcript(cplib::evaluate::Evaluator &ev, const Transcript &transcript,
+ *                              cplib::evaluate::Result result) -> cplib::evaluate::Result;
+ *
+ * with `Transcript` from common/transcript.hpp, which receives the interactor's verdict and returns
+ * the final one. It runs under the checker's time limit, so heavy verification can move there from
+ * the interactor.
  */
 
-#include <algorithm>
-#include <array>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <cstddef>
 #include <cstdint>
 #include <format>
 #include <ios>
-#include <iterator>
 #include <optional>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "common/base64.hpp"
+#include "common/compress.hpp"
+#include "common/report_frame.hpp"
+#include "common/transcript.hpp"
 #include "cplib.hpp"
 #include "testlib/checker.hpp"
 
+#if __has_include("checker_two_step_hook.hpp")
+#include "checker_two_step_hook.hpp"
+#else
+inline auto evaluate_transcript(cplib::evaluate::Evaluator &,
+                                const cplib_initializers::common::transcript::Transcript &,
+                                cplib::evaluate::Result result) -> cplib::evaluate::Result {
+  return result;
+}
+#endif
+
 inline auto xml_escape(std::string_view s) -> std::string {
   std::stringbuf buf(std::ios_base::out);
   for (auto c : s) {
@@ -66,133 +93,127 @@ inline auto xml_escape(std::string_view s) -> std::string {
   return buf.str();
 }
 
-constexpr std::array<std::uint8_t, 256> decode_table{
-    0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64,
-    0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64,
-    0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x3E, 0x64, 0x64, 0x64, 0x3F,
-    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64,
-    0x64, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
-    0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x64, 0x64, 0x64, 0x64, 0x64,
-    0x64, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
-    0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x64, 0x64, 0x64, 0x64, 0x64,
-    0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64,
-    0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64,
-    0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64,
-    0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64,
-    0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64,
-    0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64,
-    0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64,
-    0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64};
-
-inline auto is_valid_base64_char(char c) -> bool {
-  const auto decode_byte = decode_table[static_cast<unsigned char>(c)];
-  return decode_byte != 0x64;
-}
-
-inline auto is_valid_base64_str(std::string_view encoded_str) -> bool {
-  if ((encoded_str.size() % 4) == 1) {
-    return false;
-  }
+enum struct ExitCode : std::uint8_t {
+  ACCEPTED = 0,
+  WRONG_ANSWER = 1,
+  INTERNAL_ERROR = 3,
+  PARTIALLY_CORRECT = 7,
+};
 
-  if (!std::all_of(begin(encoded_str), end(encoded_str) - 2,
-                   [](char c) -> bool { return is_valid_base64_char(c); })) {
-    return false;
-  }
+struct Input {
+  static auto read(cplib::var::Reader &) -> Input { return {}; }
+};
 
-  const auto last = rbegin(encoded_str);
-  if (!is_valid_base64_char(*next(last))) {
-    return (*next(last) == '=') && (*last == '=');
-  }
+using cplib_initializers::common::transcript::Transcript;
 
-  return is_valid_base64_char(*last) || (*last == '=');
+inline auto decode_attachment(std::string_view compressed) -> std::optional<Transcript> {
+  const auto data = cplib_initializers::common::compress::decompress(compressed);
+  if (!data.has_value()) return std::nullopt;
+  return cplib_initializers::common::transcript::decode(*data);
 }
 
-inline auto decode_quad(char a, char b, char c, char d) -> std::array<std::uint8_t, 3> {
-  const std::uint32_t concat_bytes =
-      (static_cast<std::uint32_t>(decode_table[static_cast<unsigned char>(a)]) << 18) |
-      (static_cast<std::uint32_t>(decode_table[static_cast<unsigned char>(b)]) << 12) |
-      (static_cast<std::uint32_t>(decode_table[static_cast<unsigned char>(c)]) << 6) |
-      static_cast<std::uint32_t>(decode_table[static_cast<unsigned char>(d)]);
-
-  const std::uint8_t byte1 = (concat_bytes >> 16) & 0b1111'1111;
-  const std::uint8_t byte2 = (concat_bytes >> 8) & 0b1111'1111;
-  const std::uint8_t byte3 = concat_bytes & 0b1111'1111;
-  return {byte1, byte2, byte3};
+inline auto decode_transcript(std::string_view encoded) -> std::optional<Transcript> {
+  const auto compressed = cplib_initializers::common::base64::decode(encoded);
+  if (!compressed.has_value()) return std::nullopt;
+  return decode_attachment(*compressed);
 }
 
-inline auto base64_decode(std::string_view encoded_str)
-    -> std::optional<std::vector<std::uint8_t>> {
-  if (encoded_str.empty()) {
-    return std::vector<std::uint8_t>{};
-  }
+// Path of the interactor's report, kept by `Initializer` so that a binary report can be mapped.
+inline std::string report_path;
 
-  if (!is_valid_base64_str(encoded_str)) {
-    return std::nullopt;
+// A read-only mapping of a whole file. Empty if the file cannot be mapped.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &path) {
+    const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    struct stat st{};
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      const auto size = static_cast<std::size_t>(st.st_size);
+      if (auto *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0); data != MAP_FAILED) {
+        data_ = static_cast<const char *>(data);
+        size_ = size;
+      }
+    }
+    close(fd);
   }
 
-  auto const unpadded_encoded_str = encoded_str.substr(0, encoded_str.find_first_of('='));
-  auto const full_quadruples = unpadded_encoded_str.size() / 4;
-
-  std::vector<std::uint8_t> decoded_bytes;
-  decoded_bytes.reserve(((full_quadruples + 2) * 3) / 4);
+  MappedFile(const MappedFile &) = delete;
+  auto operator=(const MappedFile &) -> MappedFile & = delete;
 
-  for (std::size_t i = 0; i < full_quadruples; ++i) {
-    auto const quad = unpadded_encoded_str.substr(i * 4, 4);
-    auto const bytes = decode_quad(quad[0], quad[1], quad[2], quad[3]);
-    std::ranges::copy(bytes, std::back_inserter(decoded_bytes));
+  ~MappedFile() {
+    if (data_ != nullptr) munmap(const_cast<char *>(data_), size_);
   }
 
-  if (auto const last_quad = unpadded_encoded_str.substr(full_quadruples * 4);
-      last_quad.size() == 0) {
-    return decoded_bytes;
-  } else if ((last_quad.size() == 2) || (last_quad[2] == '=')) {
-    auto const bytes = decode_quad(last_quad[0], last_quad[1], 'A', 'A');
-    decoded_bytes.push_back(bytes[0]);
-  } else {
-    auto const bytes = decode_quad(last_quad[0], last_quad[1], last_quad[2], 'A');
-    std::copy_n(begin(bytes), 2, back_inserter(decoded_bytes));
-  }
-
-  return decoded_bytes;
-}
-
-enum struct ExitCode : std::uint8_t {
-  ACCEPTED = 0,
-  WRONG_ANSWER = 1,
-  INTERNAL_ERROR = 3,
-  PARTIALLY_CORRECT = 7,
-};
+  [[nodiscard]] auto data() const -> std::string_view { return {data_, size_}; }
 
-struct Input {
-  static auto read(cplib::var::Reader &) -> Input { return {}; }
+ private:
+  const char *data_{};
+  std::size_t size_{};
 };
 
 struct Output {
   int status;
   double score;
   std::string message;
+  std::optional<Transcript> transcript;
 
   static auto read(cplib::var::Reader &in, const Input &) -> Output {
     if (in.inner().name() == "ans") {
-      return {.status = cplib::interactor::Report::Status::ACCEPTED, .score = 1.0, .message = ""};
+      return {.status = cplib::interactor::Report::Status::ACCEPTED,
+              .score = 1.0,
+              .message = "",
+              .transcript = std::nullopt};
     }
 
-    auto status = in.read(cplib::var::i32("status"));
+    // A binary report is decoded from a mapping of the report file, and `in` is left unread. Both
+    // are read-only views of the same file, which the interactor finished writing before the
+    // checker started. The frame must span the whole mapping and match its checksum, so a file
+    // changed in between is rejected rather than misread. cplib does not require a checker to
+    // consume its output. A text report cannot start with the frame's magic byte 0x89, so it is
+    // still read through `in`.
+    if (const MappedFile report(report_path);
+        cplib_initializers::common::report_frame::is_frame(report.data())) {
+      return read_frame(in, report.data());
+    }
+
+    // A text report.
+    Output output;
+    output.status = in.read(cplib::var::i32("status"));
     // Scores are intentionally passed through without a [0, 1] restriction.
-    auto score = in.read(cplib::var::f64("score"));
-
-    // Check if there's an optional message
-    if (!in.inner().seek_eof()) {
-      auto encoded_message_str = in.read(cplib::var::String("encoded_message"));
-      auto bytes = base64_decode(encoded_message_str);
-      if (!bytes.has_value()) {
-        in.fail(std::format("Invalid Base64 encoding for message: {}", encoded_message_str));
+    output.score = in.read(cplib::var::f64("score"));
+
+    // An optional message, then an optional transcript marked with '@'. An empty message leaves an
+    // empty line, so the first token may already be the transcript.
+    auto token = in.inner().seek_eof() ? std::string() : in.read(cplib::var::String("message"));
+    if (!token.empty() && token.front() != '@') {
+      auto message = cplib_initializers::common::base64::decode(token);
+      if (!message.has_value()) {
+        in.fail(std::format("Invalid Base64 encoding for message: {}", token));
       }
-      return {
-          .status = status, .score = score, .message = std::string(bytes->begin(), bytes->end())};
-    } else {
-      return {.status = status, .score = score, .message = ""};
+      output.message = *std::move(message);
+      token = in.inner().seek_eof() ? std::string() : in.read(cplib::var::String("transcript"));
     }
+    if (!token.empty()) {
+      if (token.front() != '@') in.fail("Expected a transcript after the message");
+      output.transcript = decode_transcript(std::string_view(token).substr(1));
+      if (!output.transcript.has_value()) in.fail("Invalid transcript attachment");
+    }
+    return output;
+  }
+
+  static auto read_frame(cplib::var::Reader &in, std::string_view data) -> Output {
+    const auto frame = cplib_initializers::common::report_frame::decode(data);
+    if (!frame.has_value()) in.fail("Invalid two-step report frame: bad length or checksum");
+    Output output{.status = frame->status,
+                  .score = frame->score,
+                  .message = std::string(frame->message),
+                  .transcript = std::nullopt};
+    if (!frame->attachment.empty()) {
+      output.transcript = decode_attachment(frame->attachment);
+      if (!output.transcript.has_value()) in.fail("Invalid transcript attachment");
+    }
+    return output;
   }
 
   static auto evaluate(cplib::evaluate::Evaluator &ev, const Output &pans, const Output &,
@@ -220,9 +241,19 @@ struct Output {
         break;
     }
 
-    return {status, pans.score, pans.message};
+    cplib::evaluate::Result result{status, pans.score, pans.message};
+    if (pans.transcript.has_value()) return evaluate_transcript(ev, *pans.transcript, result);
+    return result;
+  }
+};
+
+struct Initializer : cplib_initializers::testlib::checker::Initializer {
+  using cplib_initializers::testlib::checker::Initializer::Initializer;
+
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
+    cplib_initializers::testlib::checker::Initializer::init(arg0, args);
+    report_path = cplib::cmd_args::ParsedArgs(args).ordered[1];
   }
 };
 
-CPLIB_REGISTER_CHECKER_OPT(Input, Output,
-                           ::cplib_initializers::testlib::checker::Initializer(true));
+CPLIB_REGISTER_CHECKER_OPT(Input, Output, Initializer(true));
@@ -31,10 +31,57 @@
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 
+#if __has_include("../common/interactor.hpp")
+#include "../common/interactor.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_
+// Stand-in for common/interactor.hpp when this header is used on its own: the contestant is
+// connected through cplib's own streams, with no contestant channel or profile.
+namespace cplib_initializers::common {
+namespace channel {
+struct Options {};
+}  // namespace channel
+
+namespace interactor {
+struct Initializer : cplib::interactor::Initializer {
+  Initializer() = default;
+
+  explicit Initializer(channel::Options) {}
+
+ protected:
+  auto allow_sessions() -> void {}
+
+  [[nodiscard]] auto uses_channel() const -> bool { return false; }
+
+  auto set_reporter(std::unique_ptr<cplib::interactor::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
+  }
+
+  auto set_user_fileno(int from_user_fd, int to_user_fd, cplib::trace::Level trace_level)
+      -> void {
+    set_from_user_fileno(from_user_fd, trace_level);
+    set_to_user_fileno(to_user_fd);
+  }
+};
+}  // namespace interactor
+}  // namespace cplib_initializers::common
+#endif
+
+#if __has_include("../common/resource_usage.hpp")
+#include "../common/resource_usage.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_RESOURCE_USAGE_HPP_
+// Stand-in for common/resource_usage.hpp when this header is used on its own: no usage line.
+namespace cplib_initializers::common::resource_usage {
+inline auto line() -> std::optional<std::string> { return std::nullopt; }
+}  // namespace cplib_initializers::common::resource_usage
+#endif
+
 namespace cplib_initializers::testlib::interactor {
 
 namespace detail {
@@ -161,6 +208,11 @@ struct Reporter : cplib::interactor::Reporter {
       stream << report.message << '\n';
     }
 
+    if (const auto usage = common::resource_usage::line()) {
+      // After the root element, an XML comment keeps the report well-formed.
+      stream << (appes_mode ? std::format("<!-- {} -->", *usage) : *usage) << '\n';
+    }
+
     switch (report.status) {
       case Status::INTERNAL_ERROR:
         return static_cast<int>(ExitCode::INTERNAL_ERROR);
@@ -195,16 +247,17 @@ inline auto print_help_message(std::string_view program_name) -> void {
 }
 }  // namespace detail
 
-struct Initializer : cplib::interactor::Initializer {
+struct Initializer : common::interactor::Initializer {
   bool percent_mode;
 
   explicit Initializer(bool percent_mode) : percent_mode(percent_mode) {}
 
-  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
+  Initializer(bool percent_mode, common::channel::Options channel_options)
+      : common::interactor::Initializer(std::move(channel_options)), percent_mode(percent_mode) {}
 
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
     // Use PlainTextReporter to handle errors during the init process
-    state.reporter = std::make_unique<cplib::interactor::PlainTextReporter>();
+    set_reporter(std::make_unique<cplib::interactor::PlainTextReporter>());
 
     auto parsed_args = cplib::cmd_args::ParsedArgs(args);
 
@@ -219,13 +272,14 @@ struct Initializer : cplib::interactor::Initializer {
 
     signal(SIGPIPE, SIG_IGN);
 
-    set_inf_path(parsed_args.ordered[0], cplib::trace::Level::NONE);
-    set_from_user_fileno(fileno(stdin), cplib::trace::Level::NONE);
-    set_to_user_fileno(fileno(stdout));
-
     std::optional<std::string> report_file = std::nullopt;
     if (parsed_args.ordered.size() >= 4) report_file = parsed_args.ordered[3];
 
+    set_inf_path(parsed_args.ordered[0], cplib::trace::Level::NONE);
+    // Without a report file, verdicts go to the session's stderr.
+    if (!report_file.has_value()) allow_sessions();
+    set_user_fileno(fileno(stdin), fileno(stdout), cplib::trace::Level::NONE);
+
     // Some platforms may pass some platform-specific command line arguments to testlib, ignore them
 
     bool appes_mode = false;
@@ -236,7 +290,7 @@ struct Initializer : cplib::interactor::Initializer {
       }
     }
 
-    state.reporter = std::make_unique<Reporter>(report_file, appes_mode, percent_mode);
+    set_reporter(std::make_unique<Reporter>(report_file, appes_mode, percent_mode));
   }
 };
 }  // namespace cplib_initializers::testlib::interactor
@@ -16,81 +16,69 @@
 #ifndef CPLIB_INITIALIZERS_TESTLIB_INTERACTOR_TWO_STEP_HPP_
 #define CPLIB_INITIALIZERS_TESTLIB_INTERACTOR_TWO_STEP_HPP_
 
-#include <algorithm>
-#include <array>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
 #include <csignal>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <format>
-#include <fstream>
-#include <iomanip>
-#include <ios>
 #include <iostream>
-#include <iterator>
 #include <memory>
-#include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "cplib.hpp"
 
-namespace cplib_initializers::testlib::interactor_two_step {
+#if __has_include("../common/interactor.hpp")
+#include "../common/interactor.hpp"
+#elif !defined(CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_)
+#define CPLIB_INITIALIZERS_COMMON_INTERACTOR_HPP_
+// Stand-in for common/interactor.hpp when this header is used on its own: the contestant is
+// connected through cplib's own streams, with no contestant channel or profile.
+namespace cplib_initializers::common {
+namespace channel {
+struct Options {};
+}  // namespace channel
+
+namespace interactor {
+struct Initializer : cplib::interactor::Initializer {
+  Initializer() = default;
 
-namespace detail {
-constexpr std::array<char, 64> encode_table{
-    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
-    'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
-    'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v',
-    'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'};
-
-inline auto encode_triplet(std::uint8_t a, std::uint8_t b, std::uint8_t c) -> std::array<char, 4> {
-  const std::uint32_t concat_bits = (a << 16) | (b << 8) | c;
-
-  const auto b64_char1 = encode_table[(concat_bits >> 18) & 0b0011'1111];
-  const auto b64_char2 = encode_table[(concat_bits >> 12) & 0b0011'1111];
-  const auto b64_char3 = encode_table[(concat_bits >> 6) & 0b0011'1111];
-  const auto b64_char4 = encode_table[concat_bits & 0b0011'1111];
-  return {b64_char1, b64_char2, b64_char3, b64_char4};
-}
+  explicit Initializer(channel::Options) {}
 
-inline auto base64_encode(const std::vector<std::uint8_t> &input) -> std::string {
-  const auto size = input.size();
-  const auto full_triples = size / 3;
+ protected:
+  auto allow_sessions() -> void {}
 
-  std::string output;
-  output.reserve((full_triples + 2) * 4);
-
-  for (std::size_t i = 0; i < full_triples; ++i) {
-    const auto triplet =
-        std::vector<std::uint8_t>(input.begin() + static_cast<std::ptrdiff_t>(i) * 3,
-                                  input.begin() + static_cast<std::ptrdiff_t>(i) * 3 + 3);
-    const auto base64_chars = encode_triplet(triplet[0], triplet[1], triplet[2]);
-    std::ranges::copy(base64_chars, back_inserter(output));
+  [[nodiscard]] auto uses_channel() const -> bool { return false; }
+
+  auto set_reporter(std::unique_ptr<cplib::interactor::Reporter> reporter) -> void {
+    state().reporter = std::move(reporter);
   }
 
-  if (const auto remaining_chars = size - full_triples * 3; remaining_chars == 2) {
-    const auto last_two = std::vector<std::uint8_t>(input.end() - 2, input.end());
-    const auto base64_chars = encode_triplet(last_two[0], last_two[1], 0x00);
-
-    output.push_back(base64_chars[0]);
-    output.push_back(base64_chars[1]);
-    output.push_back(base64_chars[2]);
-    output.push_back('=');
-  } else if (remaining_chars == 1) {
-    auto const base64_chars = encode_triplet(input.back(), 0x00, 0x00);
-
-    output.push_back(base64_chars[0]);
-    output.push_back(base64_chars[1]);
-    output.push_back('=');
-    output.push_back('=');
+  auto set_user_fileno(int from_user_fd, int to_user_fd, cplib::trace::Level trace_level)
+      -> void {
+    set_from_user_fileno(from_user_fd, trace_level);
+    set_to_user_fileno(to_user_fd);
   }
+};
+}  // namespace interactor
+}  // namespace cplib_initializers::common
+#endif
 
-  return output;
-}
-}  // namespace detail
+#if __has_include("../common/interactor.hpp")
+#include "../common/base64.hpp"
+#include "../common/compress.hpp"
+#include "../common/report_frame.hpp"
+#include "../common/transcript.hpp"
+#endif
+
+namespace cplib_initializers::testlib::interactor_two_step {
 
 enum struct ExitCode : std::uint8_t {
   ACCEPTED = 0,
@@ -99,24 +87,106 @@ enum struct ExitCode : std::uint8_t {
   PARTIALLY_CORRECT = 7,
 };
 
+namespace detail {
+inline std::string attached_state;
+
+#if !__has_include("../common/interactor.hpp")
+// Stand-ins for common/base64.hpp and common/transcript.hpp when this header is used on its own.
+inline auto base64_encode(std::string_view input) -> std::string {
+  constexpr std::string_view TABLE =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string output;
+  output.reserve((input.size() + 2) / 3 * 4);
+  for (std::size_t i = 0; i < input.size(); i += 3) {
+    const auto byte = [&](std::size_t j) -> std::uint32_t {
+      return j < input.size() ? static_cast<unsigned char>(input[j]) : 0;
+    };
+    const auto bits = byte(i) << 16 | byte(i + 1) << 8 | byte(i + 2);
+    for (std::size_t k = 0; k < 4; ++k) {
+      output += i + k <= input.size() ? TABLE[(bits >> (18 - 6 * k)) & 0x3f] : '=';
+    }
+  }
+  return output;
+}
+
+inline auto write_all(int fd, const char *data, std::size_t size) -> bool {
+  while (size > 0) {
+    const auto written = ::write(fd, data, size);
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) return false;
+    data += written;
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+#endif
+}  // namespace detail
+
+/**
+ * Data the interactor passes to the checker along with the transcript, such as what it computed
+ * from `inf`. Only sent when the initializer attaches the transcript.
+ */
+inline auto attached_state() -> std::string & { return detail::attached_state; }
+
+enum struct ReportFormat : std::uint8_t {
+  // A binary frame with a checksum, see common/report_frame.hpp. Without it, reports are TEXT.
+  BINARY,
+  // Status, score and Base64 message on separate lines, readable by older checkers.
+  TEXT,
+};
+
 struct Reporter : cplib::interactor::Reporter {
   using Report = cplib::interactor::Report;
   using Status = Report::Status;
 
-  std::ofstream stream;
+  int fd;
+  ReportFormat format;
+#if __has_include("../common/interactor.hpp")
+  // Channel whose kept transcript is appended to the report, if any.
+  common::channel::ToUserBuf *to_user = nullptr;
+#endif
 
-  explicit Reporter(std::string_view output_file)
-      : stream(std::string(output_file), std::ios_base::binary) {}
+  explicit Reporter(std::string_view output_file, ReportFormat format = ReportFormat::BINARY)
+      : fd(open(std::string(output_file).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666)),
+        format(format) {}
+
+  Reporter(const Reporter &) = delete;
+  auto operator=(const Reporter &) -> Reporter & = delete;
+
+  ~Reporter() override {
+    if (fd >= 0) close(fd);
+  }
 
   auto report(const Report &report) -> int override {
-    auto bytes = std::vector<std::uint8_t>(report.message.begin(), report.message.end());
-    stream << std::fixed << std::setprecision(9);
-    stream << static_cast<int>(report.status) << '\n'
-           << report.score << '\n'
-           << detail::base64_encode(bytes) << '\n';
-
-    stream.flush();
-    if (!stream) {
+#if __has_include("../common/interactor.hpp")
+    std::string attachment;
+    if (auto *recorder = to_user != nullptr ? to_user->recorder() : nullptr; recorder != nullptr) {
+      recorder->record(common::transcript::ChunkKind::STATE, attached_state());
+      to_user->finish();
+      attachment = common::compress::compress(recorder->kept());
+    }
+
+    std::string data;
+    if (format == ReportFormat::BINARY) {
+      data = common::report_frame::encode({.status = static_cast<std::uint8_t>(report.status),
+                                           .score = report.score,
+                                           .message = report.message,
+                                           .attachment = attachment});
+    } else {
+      data = std::format("{}\n{:.9f}\n{}\n", static_cast<int>(report.status), report.score,
+                         common::base64::encode(report.message));
+      if (!attachment.empty()) data += '@' + common::base64::encode(attachment) + '\n';
+    }
+
+    // One `write` in the common case, so the checker never sees a partial report.
+    const auto written =
+        fd >= 0 && common::transcript::detail::write_all(fd, data.data(), data.size());
+#else
+    const auto data = std::format("{}\n{:.9f}\n{}\n", static_cast<int>(report.status),
+                                  report.score, detail::base64_encode(report.message));
+    const auto written = fd >= 0 && detail::write_all(fd, data.data(), data.size());
+#endif
+    if (!written) {
       std::cerr << "Failed to write two-step interactor report.\n";
       return static_cast<int>(ExitCode::INTERNAL_ERROR);
     }
@@ -142,12 +212,34 @@ inline auto print_help_message(std::string_view program_name) -> void {
 }
 }  // namespace detail
 
-struct Initializer : cplib::interactor::Initializer {
-  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
-    auto &state = this->state();
+/**
+ * With `attach_transcript`, which installs the contestant channel, the report also carries a
+ * compressed transcript of the session and `attached_state()`, so that `checker_two_step.cpp` can
+ * run expensive scoring on them outside the interactor's time limit.
+ */
+struct Initializer : common::interactor::Initializer {
+  ReportFormat report_format = ReportFormat::BINARY;
+#if __has_include("../common/interactor.hpp")
+  bool attach_transcript = false;
+#endif
+
+  Initializer() = default;
 
+  explicit Initializer(ReportFormat report_format) : report_format(report_format) {}
+
+#if __has_include("../common/interactor.hpp")
+  explicit Initializer(common::channel::Options channel_options, bool attach_transcript = false,
+                       ReportFormat report_format = ReportFormat::BINARY)
+      : common::interactor::Initializer(std::move(channel_options)),
+        report_format(report_format),
+        attach_transcript(attach_transcript) {
+    this->channel_options->keep_transcript |= attach_transcript;
+  }
+#endif
+
+  auto init(std::string_view arg0, const std::vector<std::string> &args) -> void override {
     // Use PlainTextReporter to handle errors during the init process
-    state.reporter = std::make_unique<cplib::interactor::PlainTextReporter>();
+    set_reporter(std::make_unique<cplib::interactor::PlainTextReporter>());
 
     auto parsed_args = cplib::cmd_args::ParsedArgs(args);
 
@@ -163,12 +255,15 @@ struct Initializer : cplib::interactor::Initializer {
     signal(SIGPIPE, SIG_IGN);
 
     set_inf_path(parsed_args.ordered[0], cplib::trace::Level::NONE);
-    set_from_user_fileno(fileno(stdin), cplib::trace::Level::NONE);
-    set_to_user_fileno(fileno(stdout));
+    set_user_fileno(fileno(stdin), fileno(stdout), cplib::trace::Level::NONE);
 
     const auto &report_file = parsed_args.ordered[1];
 
-    state.reporter = std::make_unique<Reporter>(report_file);
+    auto reporter = std::make_unique<Reporter>(report_file, report_format);
+#if __has_include("../common/interactor.hpp")
+    if (attach_transcript) reporter->to_user = to_user_buf.get();
+#endif
+    set_reporter(std::move(reporter));
   }
 };
 }  // namespace cplib_initializers::testlib::interactor_two_step
@@ -0,0 +1,38 @@
+#include <cstdint>
+#include <format>
+
+#include "cplib.hpp"
+#include "hustoj/checker.hpp"
+
+namespace hustoj = cplib_initializers::hustoj::checker;
+using Result = cplib::evaluate::Result;
+
+struct Input {
+  std::int32_t count;
+
+  static auto read(cplib::var::Reader &in) -> Input { return {in.read(cplib::var::i32("count"))}; }
+};
+
+// Expects `count` zeros, checking each one as it is read.
+struct Output {
+  static auto read(cplib::var::Reader &in, const Input &input) -> Output {
+    if (in.inner().name() == "ans") return {};
+    for (std::int32_t i = 0; i < input.count; ++i) {
+      const auto value = in.read(cplib::var::i32("value"));
+      hustoj::quit_unless_accepted(value == 0 ? Result::ac()
+                                              : Result::wa(std::format("case {}", i)));
+    }
+    return {};
+  }
+
+  static auto evaluate(cplib::evaluate::Evaluator &, const Output &, const Output &, const Input &)
+      -> Result {
+    return Result::ac();
+  }
+};
+
+#ifndef EARLY_EXIT
+#define EARLY_EXIT true
+#endif
+
+CPLIB_REGISTER_CHECKER_OPT(Input, Output, hustoj::Initializer(EARLY_EXIT));
@@ -0,0 +1,23 @@
+#include <cstdint>
+#include <format>
+
+#include "cplib.hpp"
+#include "spoj/checker.hpp"
+
+struct Input {
+  static auto read(cplib::var::Reader &) -> Input { return {}; }
+};
+
+// Accepts any output and reports the measured source.
+struct Output {
+  static auto read(cplib::var::Reader &, const Input &) -> Output { return {}; }
+
+  static auto evaluate(cplib::evaluate::Evaluator &, const Output &, const Output &, const Input &)
+      -> cplib::evaluate::Result {
+    const auto &source = cplib_initializers::spoj::checker::source();
+    return cplib::evaluate::Result::ac(
+        std::format("source {} bytes, {} newlines", source.length, source.histogram->at('\n')));
+  }
+};
+
+CPLIB_REGISTER_CHECKER_OPT(Input, Output, cplib_initializers::spoj::checker::Initializer(true));
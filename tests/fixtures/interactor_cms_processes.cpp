@@ -0,0 +1,21 @@
+#include "cms/interactor.hpp"
+#include "cplib.hpp"
+
+CPLIB_REGISTER_INTERACTOR_OPT(interactor, cplib_initializers::cms::interactor::Initializer());
+
+auto interactor_main() -> void {
+  auto &processes = cplib_initializers::cms::interactor::processes(interactor);
+  const auto expected = interactor.inf.read(cplib::var::i32("expected"));
+  for (std::size_t i = 0; i < processes.size(); ++i) {
+    processes.to_user(i) << "ready " << i << '\n';
+  }
+  for (std::size_t answered = 0; answered < processes.size(); ++answered) {
+    const auto index = processes.wait_any();
+    const auto actual = processes.from_user(index).read(cplib::var::i32("actual"));
+    if (actual != expected + static_cast<int>(index)) {
+      interactor.quit_wa("unexpected response");
+    }
+    processes.deactivate(index);
+  }
+  interactor.quit_ac();
+}
@@ -0,0 +1,20 @@
+#include "coci/interactor.hpp"
+#include "common/coroutine.hpp"
+#include "cplib.hpp"
+
+CPLIB_REGISTER_INTERACTOR_OPT(interactor, cplib_initializers::coci::interactor::Initializer(
+                                              cplib_initializers::common::channel::Options{}));
+
+namespace coroutine = cplib_initializers::common::coroutine;
+
+auto interact() -> coroutine::Task<> {
+  const auto expected = interactor.inf.read(cplib::var::i32("expected"));
+  interactor.to_user << "ready\n" << std::flush;
+  const auto actual = co_await coroutine::read(interactor.from_user, cplib::var::i32("actual"));
+  if (actual == expected) {
+    interactor.quit_ac();
+  }
+  interactor.quit_wa("unexpected response");
+}
+
+auto interactor_main() -> void { coroutine::run(interact()); }
@@ -0,0 +1,17 @@
+#include <string>
+
+#include "cplib.hpp"
+#include "testlib/interactor_two_step.hpp"
+
+namespace two_step = cplib_initializers::testlib::interactor_two_step;
+
+CPLIB_REGISTER_INTERACTOR_OPT(interactor, two_step::Initializer({}, true));
+
+// Leaves checking the answer to the checker's hook.
+auto interactor_main() -> void {
+  const auto expected = interactor.inf.read(cplib::var::i32("expected"));
+  interactor.to_user << "ready\n" << std::flush;
+  interactor.from_user.read(cplib::var::i32("actual"));
+  two_step::attached_state() = std::to_string(expected) + "\n";
+  interactor.quit_ac();
+}
@@ -8,7 +8,7 @@
 
 namespace {
 constexpr const char *kArbiterReportPath = "/tmp/_eval.score";
-constexpr const char *kRedirectEnv = "CPLIB_INITIALIZERS_ARBITER_REPORT";
+constexpr const char *kRedirectEnv = "REDIRECT_TMP_EVAL_SCORE";
 
 auto redirected_path(const char *pathname) -> const char * {
   const char *const target = std::getenv(kRedirectEnv);
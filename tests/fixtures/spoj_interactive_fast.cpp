@@ -0,0 +1,17 @@
+// A legacy SPOJ interactor written against the C API, in fast mode.
+#define SPOJ_INTERACTIVE_FAST
+#include "spoj/spoj_interactive.h"
+
+auto main() -> int {
+  spoj_init();
+  int rounds;
+  if (fscanf(spoj_p_in, "%d", &rounds) != 1) return SPOJ_RV_IE;
+  for (int i = 0; i < rounds; ++i) {
+    int answer;
+    spoj_printf("%d\n", i);
+    spoj_scanf("%d", &answer);
+    spoj_assert(answer == i + 1);
+  }
+  fprintf(spoj_p_info, "%u\n", spoj_srclen());
+  return SPOJ_RV_AC;
+}
@@ -0,0 +1,13 @@
+#include "common/transcript.hpp"
+#include "cplib.hpp"
+
+using cplib_initializers::common::transcript::Transcript;
+
+// Accepts if the contestant answered with the line the interactor attached as its state.
+inline auto evaluate_transcript(cplib::evaluate::Evaluator &, const Transcript &transcript,
+                                cplib::evaluate::Result result) -> cplib::evaluate::Result {
+  if (transcript.to_user != "ready\n" || transcript.from_user != transcript.state) {
+    return cplib::evaluate::Result::wa("transcript: unexpected response");
+  }
+  return result;
+}
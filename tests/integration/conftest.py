@@ -65,11 +65,13 @@ def interact_stdio(
     *arguments: pathlib.Path | str,
     cwd: pathlib.Path,
     response: int = 7,
+    env: dict[str, str] | None = None,
     timeout: float = 5,
 ) -> tuple[subprocess.CompletedProcess[str], str]:
     process = subprocess.Popen(
         [str(executable), *(str(argument) for argument in arguments)],
         cwd=cwd,
+        env=env,
         text=True,
         stdin=subprocess.PIPE,
         stdout=subprocess.PIPE,
@@ -1,5 +1,8 @@
+import json
 import os
 import pathlib
+import subprocess
+import time
 
 import pytest
 
@@ -103,6 +106,81 @@ def test_fixed_files(
     assert "internal_error" not in result.stderr
 
 
+@pytest.mark.parametrize("by_fd", [False, True], ids=["path", "fd"])
+@pytest.mark.parametrize(
+    ("target", "input_name", "output_name", "answer_name"),
+    [
+        ("checker_hello_judge", "input", "user_out", "answer"),
+        ("checker_nowcoder", "input", "user_output", "output"),
+        ("checker_syzoj", "input", "user_out", "answer"),
+    ],
+    ids=["hello_judge", "nowcoder", "syzoj"],
+)
+def test_fixed_files_root(
+    fixture_dir: pathlib.Path,
+    tmp_path: pathlib.Path,
+    target: str,
+    input_name: str,
+    output_name: str,
+    answer_name: str,
+    by_fd: bool,
+):
+    root = tmp_path / "root"
+    root.mkdir()
+    cwd = tmp_path / "elsewhere"
+    cwd.mkdir()
+    write(root / input_name, "7\n")
+    write(root / output_name, "6\n")
+    write(root / answer_name, "7\n")
+
+    root_fd = os.open(root, os.O_RDONLY | os.O_DIRECTORY)
+    try:
+        result = run(
+            fixture_dir / target,
+            f"--root-fd={root_fd}" if by_fd else f"--root={root}",
+            cwd=cwd,
+            pass_fds=(root_fd,),
+        )
+    finally:
+        os.close(root_fd)
+
+    assert "internal_error" not in result.stderr
+    if target == "checker_hello_judge":
+        assert (root / "score").read_text(encoding="utf-8") == "0"
+        assert "wrong_answer" in (root / "message").read_text(encoding="utf-8")
+        assert list(cwd.iterdir()) == []
+    elif target == "checker_nowcoder":
+        assert result.returncode == 1
+    else:
+        assert result.stdout == "0.000000000"
+
+
+def test_hello_judge_report_files(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    for name in ("input", "user_out", "answer"):
+        write(tmp_path / name, "7\n")
+
+    result = run(
+        fixture_dir / "checker_hello_judge",
+        cwd=tmp_path,
+        preexec_fn=lambda: os.umask(0o027),
+    )
+
+    assert result.returncode == 0, result.stderr
+    assert (tmp_path / "score").stat().st_mode & 0o777 == 0o640
+    assert (tmp_path / "message").stat().st_mode & 0o777 == 0o640
+
+
+def test_hello_judge_unwritable_score(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    for name in ("input", "user_out", "answer"):
+        write(tmp_path / name, "7\n")
+    (tmp_path / "score").mkdir()
+
+    result = run(fixture_dir / "checker_hello_judge", cwd=tmp_path)
+
+    assert result.returncode != 0
+    assert "Failed to write score" in result.stderr
+
+
 def test_kattis_stdin_feedback(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
     input_file, _, answer_file = common_files(tmp_path)
     feedback = tmp_path / "feedback"
@@ -162,11 +240,51 @@ def test_spoj_file_descriptors(fixture_dir: pathlib.Path, tmp_path: pathlib.Path
     assert "accepted" in info_file.read_text(encoding="utf-8")
 
 
+@pytest.mark.parametrize("source_kind", ["file", "pipe"])
+def test_spoj_source_metric(
+    fixture_dir: pathlib.Path, tmp_path: pathlib.Path, source_kind: str
+):
+    input_file, output_file, answer_file = common_files(tmp_path)
+    info_file = tmp_path / "info.txt"
+    source_text = "main(){}\n" * 3
+    source_file = write(tmp_path / "source.c", source_text)
+    source_read, source_write = os.pipe()
+    os.write(source_write, source_text.encode())
+    os.close(source_write)
+    with (
+        input_file.open("rb") as problem_input,
+        output_file.open("rb") as tested_output,
+        answer_file.open("rb") as problem_output,
+        source_file.open("rb") as tested_source,
+        info_file.open("wb") as info,
+        (tmp_path / "user-info.txt").open("wb") as user_info,
+    ):
+        mappings = {
+            0: problem_input.fileno(),
+            3: tested_output.fileno(),
+            4: problem_output.fileno(),
+            5: tested_source.fileno() if source_kind == "file" else source_read,
+            6: info.fileno(),
+            7: user_info.fileno(),
+        }
+        result = run_with_fds(
+            fixture_dir, fixture_dir / "checker_spoj_golf", mappings, cwd=tmp_path
+        )
+    os.close(source_read)
+
+    assert result.returncode == 0, result.stderr
+    assert "source 27 bytes, 3 newlines" in info_file.read_text(encoding="utf-8")
+
+
 def test_arbiter_report_redirect(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
     input_file, output_file, answer_file = common_files(tmp_path)
-    report = write(tmp_path / "_eval.score", "")
-    env = os.environ | {
-        "CPLIB_INITIALIZERS_ARBITER_REPORT": str(report),
+    report = write(tmp_path / "_eval.score", "stale report from an earlier run\n")
+    env = {
+        key: value
+        for key, value in os.environ.items()
+        if key != "CPLIB_INITIALIZERS_ARBITER_REPORT"
+    } | {
+        "REDIRECT_TMP_EVAL_SCORE": str(report),
         "LD_PRELOAD": str(fixture_dir / "libredirect_tmp_eval_score.so"),
     }
 
@@ -179,5 +297,390 @@ def test_arbiter_report_redirect(fixture_dir: pathlib.Path, tmp_path: pathlib.Pa
         env=env,
     )
 
+    assert result.returncode == 0, result.stderr
+    assert report.read_text(encoding="utf-8").startswith("accepted")
+
+
+def test_arbiter_report_path(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    input_file, output_file, answer_file = common_files(tmp_path)
+    report = tmp_path / "_eval.score"
+    env = os.environ | {"CPLIB_INITIALIZERS_ARBITER_REPORT": str(report)}
+
+    result = run(
+        fixture_dir / "checker_arbiter",
+        input_file,
+        output_file,
+        answer_file,
+        cwd=tmp_path,
+        env=env,
+    )
+
     assert result.returncode == 0, result.stderr
     assert "accepted" in report.read_text(encoding="utf-8")
+    assert list(tmp_path.glob("_eval.score.*")) == []
+
+
+def test_arbiter_report_path_argument(
+    fixture_dir: pathlib.Path, tmp_path: pathlib.Path
+):
+    env_report = tmp_path / "env.score"
+    env = os.environ | {"CPLIB_INITIALIZERS_ARBITER_REPORT": str(env_report)}
+
+    # Checkers running side by side each write their own report.
+    processes = []
+    for case in range(8):
+        case_dir = tmp_path / str(case)
+        case_dir.mkdir()
+        input_file, output_file, answer_file = common_files(case_dir, 7 - case % 2)
+        processes.append(
+            subprocess.Popen(
+                [
+                    str(fixture_dir / "checker_arbiter"),
+                    str(input_file),
+                    str(output_file),
+                    str(answer_file),
+                    f"--report-path={case_dir / 'report.score'}",
+                ],
+                env=env,
+                stderr=subprocess.PIPE,
+            )
+        )
+    for case, process in enumerate(processes):
+        assert process.wait(timeout=10) == 0
+        report = (tmp_path / str(case) / "report.score").read_text(encoding="utf-8")
+        assert report.startswith("accepted" if case % 2 == 0 else "wrong_answer")
+    assert not env_report.exists()
+
+
+def test_luogu_grader_pipes_input(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    # Large enough to need several sendfile calls into the pipe.
+    input_text = "7\n" + "\n" * (1 << 20)
+    input_file = write(tmp_path / "input.txt", input_text)
+    answer_file = write(tmp_path / "answer.txt", "7\n")
+
+    # Like a program, read the whole input before answering.
+    process = subprocess.Popen(
+        [str(fixture_dir / "checker_luogu"), str(input_file), "dummy", str(answer_file)],
+        cwd=tmp_path,
+        text=True,
+        stdin=subprocess.PIPE,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+    )
+    assert process.stdout is not None
+    piped = process.stdout.read(len(input_text))
+    _, stderr = process.communicate("7\n", timeout=5)
+
+    assert process.returncode == 0, stderr
+    assert piped == input_text
+
+
+def test_luogu_grader_reads_output_while_piping_input(
+    fixture_dir: pathlib.Path, tmp_path: pathlib.Path
+):
+    # Far more input than a pipe holds, and nobody reads it.
+    input_file = write(tmp_path / "input.txt", "7\n" + "\n" * (1 << 22))
+    answer_file = write(tmp_path / "answer.txt", "7\n")
+    read_end, write_end = os.pipe()
+
+    try:
+        result = subprocess.run(
+            [str(fixture_dir / "checker_luogu"), str(input_file), "dummy", str(answer_file)],
+            cwd=tmp_path,
+            input="7\n",
+            text=True,
+            stdout=write_end,
+            stderr=subprocess.PIPE,
+            timeout=5,
+            check=False,
+        )
+    finally:
+        os.close(read_end)
+        os.close(write_end)
+
+    assert result.returncode == 0, result.stderr
+
+
+def test_luogu_grader_reports_failed_input(
+    fixture_dir: pathlib.Path, tmp_path: pathlib.Path
+):
+    input_file = write(tmp_path / "input.txt", "7\n")
+    answer_file = write(tmp_path / "answer.txt", "7\n")
+
+    # The program's output arrives only after sending the input has failed.
+    with open("/dev/full", "wb") as full:
+        process = subprocess.Popen(
+            [
+                str(fixture_dir / "checker_luogu"),
+                str(input_file),
+                "dummy",
+                str(answer_file),
+            ],
+            cwd=tmp_path,
+            text=True,
+            stdin=subprocess.PIPE,
+            stdout=full,
+            stderr=subprocess.PIPE,
+        )
+        time.sleep(0.2)
+        _, stderr = process.communicate("7\n", timeout=5)
+
+    assert process.returncode == 3, stderr
+    assert "Failed to write the input file to stdout" in stderr
+
+
+def test_hustoj_early_exit(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    input_file = write(tmp_path / "input.txt", "1000000\n")
+    answer_file = write(tmp_path / "answer.txt", "")
+
+    # The output stays open: only a checker that stops at the mismatch can finish.
+    process = subprocess.Popen(
+        [
+            str(fixture_dir / "checker_hustoj_early"),
+            str(input_file),
+            str(answer_file),
+            "/dev/stdin",
+        ],
+        cwd=tmp_path,
+        text=True,
+        stdin=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+    )
+    assert process.stdin is not None
+    process.stdin.write("0\n0\n1\n")
+    process.stdin.flush()
+    try:
+        returncode = process.wait(timeout=5)
+    finally:
+        process.kill()
+        process.stdin.close()
+
+    assert returncode == 1
+
+
+def test_hustoj_without_early_exit(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    input_file = write(tmp_path / "input.txt", "3\n")
+    answer_file = write(tmp_path / "answer.txt", "")
+
+    process = subprocess.Popen(
+        [
+            str(fixture_dir / "checker_hustoj_no_early"),
+            str(input_file),
+            str(answer_file),
+            "/dev/stdin",
+        ],
+        cwd=tmp_path,
+        text=True,
+        stdin=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+    )
+    assert process.stdin is not None
+    try:
+        process.stdin.write("0\n1\n")
+        process.stdin.flush()
+        # The mismatch does not end the check: the checker waits for the last value.
+        with pytest.raises(subprocess.TimeoutExpired):
+            process.wait(timeout=0.5)
+        process.stdin.write("0\n")
+        process.stdin.close()
+        returncode = process.wait(timeout=5)
+    finally:
+        process.kill()
+
+    assert returncode == 0
+
+
+def test_max_ouf_bytes_file(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    input_file, _, answer_file = common_files(tmp_path)
+    output_file = write(tmp_path / "output.txt", "7" + " " * 16 + "\n")
+
+    result = run(
+        fixture_dir / "checker_testlib_limited",
+        input_file,
+        output_file,
+        answer_file,
+        cwd=tmp_path,
+    )
+
+    assert result.returncode == 1, result.stderr
+    assert "exceeds the limit of 16 bytes" in result.stderr
+
+
+def test_max_ouf_bytes_pipe(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    input_file, _, answer_file = common_files(tmp_path)
+    feedback = tmp_path / "feedback"
+    feedback.mkdir()
+
+    # The output never ends: only a checker that counts the bytes as they arrive can finish.
+    process = subprocess.Popen(
+        [
+            str(fixture_dir / "checker_kattis_limited"),
+            str(input_file),
+            str(answer_file),
+            str(feedback),
+        ],
+        cwd=tmp_path,
+        stdin=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+    )
+    assert process.stdin is not None
+    process.stdin.write(b"7" + b" " * 64)
+    process.stdin.flush()
+    try:
+        returncode = process.wait(timeout=5)
+    finally:
+        process.kill()
+        process.stdin.close()
+
+    assert returncode == 43
+    judge_message = (feedback / "judgemessage.txt").read_text(encoding="utf-8")
+    assert judge_message == "WA Output exceeds the limit of 16 bytes\n"
+
+
+def test_max_ouf_bytes_no_default_limit(
+    fixture_dir: pathlib.Path, tmp_path: pathlib.Path
+):
+    input_file, _, answer_file = common_files(tmp_path)
+    output_file = write(tmp_path / "output.txt", "7" + " " * (8 << 20) + "\n")
+    feedback = tmp_path / "feedback"
+    feedback.mkdir()
+
+    with output_file.open("rb") as output:
+        result = subprocess.run(
+            [
+                str(fixture_dir / "checker_kattis"),
+                str(input_file),
+                str(answer_file),
+                str(feedback),
+            ],
+            cwd=tmp_path,
+            stdin=output,
+            capture_output=True,
+            timeout=5,
+            check=False,
+        )
+
+    assert result.returncode == 42, result.stderr
+
+
+def test_profile(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    input_file, output_file, answer_file = common_files(tmp_path)
+    wrong_output = write(tmp_path / "wrong.txt", "8\n")
+    profile = tmp_path / "profile.jsonl"
+    env = {**os.environ, "CPLIB_INITIALIZERS_PROFILE": str(profile)}
+
+    for output, expected_exit in ((output_file, 0), (wrong_output, 1)):
+        result = run(
+            fixture_dir / "checker_testlib",
+            input_file,
+            output,
+            answer_file,
+            cwd=tmp_path,
+            env=env,
+        )
+        assert result.returncode == expected_exit, result.stderr
+
+    records = [json.loads(line) for line in profile.read_text().splitlines()]
+    assert [record["exit_code"] for record in records] == [0, 1]
+    for record in records:
+        assert record["mode"] == "checker"
+        assert all(value is not None for value in record["phases_ns"].values())
+        assert {
+            name: stream["bytes"] for name, stream in record["streams"].items()
+        } == {
+            "inf": 2,
+            "ouf": 2,
+            "ans": 2,
+        }
+        # Hardware counters depend on the sandbox, but the record always has both phases.
+        assert set(record["counters"]) == {"read", "evaluate"}
+
+
+def test_profile_init_failure(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    profile = tmp_path / "profile.jsonl"
+    env = {**os.environ, "CPLIB_INITIALIZERS_PROFILE": str(profile)}
+
+    result = run(fixture_dir / "checker_testlib", cwd=tmp_path, env=env)
+
+    assert result.returncode != 0
+    (record,) = [json.loads(line) for line in profile.read_text().splitlines()]
+    assert record["mode"] == "checker"
+    assert record["exit_code"] == result.returncode
+    assert record["phases_ns"]["static_init"] is not None
+    assert record["phases_ns"]["report"] is not None
+    assert record["streams"] == {}
+
+
+def test_profile_stdin(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    input_file, _, answer_file = common_files(tmp_path)
+    profile = tmp_path / "profile.jsonl"
+    env = {**os.environ, "CPLIB_INITIALIZERS_PROFILE": str(profile)}
+
+    result = run(
+        fixture_dir / "checker_kattis",
+        input_file,
+        answer_file,
+        tmp_path,
+        cwd=tmp_path,
+        env=env,
+        input_text="7\n",
+    )
+
+    assert result.returncode == 42, result.stderr
+    (record,) = [json.loads(line) for line in profile.read_text().splitlines()]
+    assert record["exit_code"] == 42
+    assert record["streams"]["ouf"]["bytes"] == 2
+
+
+def test_resource_usage(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    input_file, output_file, answer_file = common_files(tmp_path)
+    feedback = tmp_path / "feedback"
+    feedback.mkdir()
+    report = tmp_path / "report.xml"
+    env = {**os.environ, "CPLIB_INITIALIZERS_RESOURCE_USAGE": "1"}
+
+    kattis = run(
+        fixture_dir / "checker_kattis",
+        input_file,
+        answer_file,
+        feedback,
+        cwd=tmp_path,
+        env=env,
+        input_text="7\n",
+    )
+    testlib = run(
+        fixture_dir / "checker_testlib",
+        input_file,
+        output_file,
+        answer_file,
+        report,
+        "-appes",
+        cwd=tmp_path,
+        env=env,
+    )
+    cms = run(
+        fixture_dir / "checker_cms",
+        input_file,
+        answer_file,
+        output_file,
+        cwd=tmp_path,
+        env=env,
+    )
+
+    assert kattis.returncode == 42, kattis.stderr
+    assert (feedback / "judgemessage.txt").read_text(
+        encoding="utf-8"
+    ) == "OK values match\n"
+    judge_error = (feedback / "judgeerror.txt").read_text(encoding="utf-8")
+    assert judge_error.startswith("resource usage: max_rss=")
+
+    assert testlib.returncode == 0, testlib.stderr
+    result, comment = report.read_text(encoding="utf-8").splitlines()
+    assert result.endswith('<result outcome = "accepted">values match</result>')
+    assert comment.startswith("<!-- resource usage: ") and comment.endswith(" -->")
+
+    assert cms.returncode == 0, cms.stderr
+    assert cms.stdout == "1.000000000\n"
+    status, usage = cms.stderr.splitlines()
+    assert status == "values match"
+    assert "involuntary_switches=" in usage
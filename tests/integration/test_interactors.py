@@ -1,7 +1,12 @@
+import base64
+import json
 import os
 import pathlib
+import socket
 import subprocess
 import sys
+import threading
+import time
 
 import pytest
 
@@ -15,8 +20,10 @@ from conftest import interact_stdio, run, run_with_fds, write
         ("interactor_kattis", ("input.txt", "dummy", "feedback"), "input.txt", 42),
         ("interactor_syzoj", (), "input", 0),
         ("interactor_testlib", ("input.txt",), "input.txt", 0),
+        ("interactor_coci_channel", ("input.txt",), "input.txt", 0),
+        ("interactor_coroutine", ("input.txt",), "input.txt", 0),
     ],
-    ids=["coci", "kattis", "syzoj", "testlib"],
+    ids=["coci", "kattis", "syzoj", "testlib", "coci_channel", "coroutine"],
 )
 def test_contestant_channels(
     fixture_dir: pathlib.Path,
@@ -43,6 +50,218 @@ def test_contestant_channels(
     assert "internal_error" not in result.stderr
 
 
+def test_record_and_replay(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    input_file = write(tmp_path / "input.txt", "7\n")
+    transcript = tmp_path / "session.transcript"
+
+    result, ready = interact_stdio(
+        fixture_dir / "interactor_coci_channel",
+        input_file,
+        cwd=tmp_path,
+        env={**os.environ, "CPLIB_INITIALIZERS_RECORD": str(transcript)},
+    )
+    assert ready == "ready\n"
+    assert result.returncode == 0, result.stderr
+    assert transcript.read_bytes().startswith(b"CPLIBRR1")
+
+    replay_env = {**os.environ, "CPLIB_INITIALIZERS_REPLAY": str(transcript)}
+    replayed = run(
+        fixture_dir / "interactor_coci_channel",
+        input_file,
+        cwd=tmp_path,
+        env=replay_env,
+        input_text="",
+    )
+    assert replayed.returncode == 0, replayed.stderr
+    assert replayed.stdout == ""
+
+    write(input_file, "8\n")
+    rescored = run(
+        fixture_dir / "interactor_coci_channel",
+        input_file,
+        cwd=tmp_path,
+        env=replay_env,
+        input_text="",
+    )
+    assert rescored.returncode == 1, rescored.stderr
+
+    transcript.write_bytes(b"CPLIBRR1\x00\x07steady\n\x01\x027\n\x02\x00")
+    diverged = run(
+        fixture_dir / "interactor_coci_channel",
+        input_file,
+        cwd=tmp_path,
+        env=replay_env,
+        input_text="",
+    )
+    assert diverged.returncode == 3, diverged.stderr
+
+
+def test_record_without_channel_options(
+    fixture_dir: pathlib.Path, tmp_path: pathlib.Path
+):
+    input_file = write(tmp_path / "input.txt", "7\n")
+    transcript = tmp_path / "session.transcript"
+
+    # The environment alone installs the channel of an interactor built without options.
+    result, ready = interact_stdio(
+        fixture_dir / "interactor_coci",
+        input_file,
+        cwd=tmp_path,
+        env={**os.environ, "CPLIB_INITIALIZERS_RECORD": str(transcript)},
+    )
+    assert ready == "ready\n"
+    assert result.returncode == 0, result.stderr
+    assert transcript.read_bytes().startswith(b"CPLIBRR1")
+
+
+def run_server_session(
+    socket_path: pathlib.Path, response: int, report_fd: int = 2
+) -> tuple[int, str]:
+    contestant_in_read, contestant_in_write = os.pipe()
+    contestant_out_read, contestant_out_write = os.pipe()
+    for _ in range(500):
+        try:
+            connection = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            connection.connect(str(socket_path))
+            break
+        except (FileNotFoundError, ConnectionRefusedError):
+            connection.close()
+            time.sleep(0.01)
+    else:
+        raise AssertionError("interactor server did not start")
+    with connection:
+        socket.send_fds(
+            connection, [b"\0"], [contestant_in_read, contestant_out_write, report_fd]
+        )
+        os.close(contestant_in_read)
+        os.close(contestant_out_write)
+        with (
+            os.fdopen(contestant_out_read) as reader,
+            os.fdopen(contestant_in_write, "w") as writer,
+        ):
+            ready = reader.readline()
+            writer.write(f"{response}\n")
+            writer.flush()
+        status = b""
+        while len(status) < 4:
+            chunk = connection.recv(4 - len(status))
+            assert chunk, "session lost"
+            status += chunk
+    return int.from_bytes(status, sys.byteorder, signed=True), ready
+
+
+def start_server(
+    executable: pathlib.Path,
+    *arguments: pathlib.Path | str,
+    cwd: pathlib.Path,
+    socket_path: pathlib.Path,
+    env: dict[str, str] | None = None,
+) -> subprocess.Popen[bytes]:
+    return subprocess.Popen(
+        [str(executable), *(str(argument) for argument in arguments)],
+        cwd=cwd,
+        env={**(env or os.environ), "CPLIB_INITIALIZERS_SERVER": str(socket_path)},
+        stdin=subprocess.DEVNULL,
+        stdout=subprocess.DEVNULL,
+        stderr=subprocess.PIPE,
+    )
+
+
+def test_warm_server_sessions(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    input_file = write(tmp_path / "input.txt", "7\n")
+    socket_path = tmp_path / "interactor.sock"
+    transcript = tmp_path / "session.transcript"
+    server = start_server(
+        fixture_dir / "interactor_coci_channel",
+        input_file,
+        cwd=tmp_path,
+        socket_path=socket_path,
+        env={**os.environ, "CPLIB_INITIALIZERS_RECORD": str(transcript)},
+    )
+    try:
+        assert run_server_session(socket_path, 7) == (0, "ready\n")
+        assert run_server_session(socket_path, 8) == (1, "ready\n")
+        assert run_server_session(socket_path, 7) == (0, "ready\n")
+    finally:
+        server.terminate()
+        server.communicate(timeout=5)
+
+    transcripts = list(tmp_path.glob("session.transcript.*"))
+    assert len(transcripts) == 3
+    assert not transcript.exists()
+
+
+def test_warm_server_reports_per_session(
+    fixture_dir: pathlib.Path, tmp_path: pathlib.Path
+):
+    input_file = write(tmp_path / "input.txt", "7\n")
+    socket_path = tmp_path / "interactor.sock"
+    server = start_server(
+        fixture_dir / "interactor_testlib_channel",
+        input_file,
+        cwd=tmp_path,
+        socket_path=socket_path,
+    )
+    try:
+        for response, expected_exit, verdict in [
+            (7, 0, "ok"),
+            (8, 1, "wrong answer"),
+            (7, 0, "ok"),
+        ]:
+            report_read, report_write = os.pipe()
+            try:
+                result = run_server_session(socket_path, response, report_write)
+            finally:
+                os.close(report_write)
+            with os.fdopen(report_read) as report:
+                assert result == (expected_exit, "ready\n")
+                assert report.read().startswith(verdict)
+    finally:
+        server.terminate()
+        server.communicate(timeout=5)
+
+
+@pytest.mark.parametrize(
+    ("target", "arguments", "message_file"),
+    [
+        (
+            "interactor_kattis_channel",
+            ("input.txt", "dummy", "feedback"),
+            "judgeerror.txt",
+        ),
+        (
+            "interactor_testlib_channel",
+            ("input.txt", "dummy", "dummy", "report.txt"),
+            None,
+        ),
+    ],
+    ids=["kattis", "testlib_report_file"],
+)
+def test_server_refused_for_report_files(
+    fixture_dir: pathlib.Path,
+    tmp_path: pathlib.Path,
+    target: str,
+    arguments: tuple[str, ...],
+    message_file: str | None,
+):
+    write(tmp_path / "input.txt", "7\n")
+    (tmp_path / "feedback").mkdir()
+    socket_path = tmp_path / "interactor.sock"
+    server = start_server(
+        fixture_dir / target, *arguments, cwd=tmp_path, socket_path=socket_path
+    )
+    _, stderr = server.communicate(timeout=5)
+
+    assert server.returncode != 0
+    assert not socket_path.exists()
+    message = (
+        (tmp_path / "feedback" / message_file).read_text()
+        if message_file is not None
+        else stderr.decode()
+    )
+    assert "cannot serve sessions" in message
+
+
 def test_cms_fifo_endpoints(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
     write(tmp_path / "input.txt", "7\n")
     from_user = tmp_path / "from-user.fifo"
@@ -84,6 +303,57 @@ def test_cms_fifo_endpoints(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
     assert interactor_stdout == "1.000000000\n"
 
 
+def test_cms_multiple_processes(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    write(tmp_path / "input.txt", "7\n")
+    arguments = []
+    contestants = []
+    for index, delay in enumerate((0.5, 0.0, 0.2)):
+        from_user = tmp_path / f"from-user-{index}.fifo"
+        to_user = tmp_path / f"to-user-{index}.fifo"
+        os.mkfifo(from_user)
+        os.mkfifo(to_user)
+        arguments += [str(from_user), str(to_user)]
+        contestants.append(
+            subprocess.Popen(
+                [
+                    sys.executable,
+                    "-c",
+                    (
+                        "import pathlib,sys,time; "
+                        "reader=pathlib.Path(sys.argv[1]).open('r'); "
+                        "writer=pathlib.Path(sys.argv[2]).open('w'); "
+                        "assert reader.readline() == f'ready {sys.argv[3]}\\n'; "
+                        "time.sleep(float(sys.argv[4])); "
+                        "writer.write(f'{7 + int(sys.argv[3])}\\n'); writer.flush()"
+                    ),
+                    str(to_user),
+                    str(from_user),
+                    str(index),
+                    str(delay),
+                ],
+                cwd=tmp_path,
+                text=True,
+                stdout=subprocess.PIPE,
+                stderr=subprocess.PIPE,
+            )
+        )
+    interactor = subprocess.Popen(
+        [str(fixture_dir / "interactor_cms_processes"), *arguments],
+        cwd=tmp_path,
+        text=True,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+    )
+
+    for contestant in contestants:
+        _, contestant_stderr = contestant.communicate(timeout=5)
+        assert contestant.returncode == 0, contestant_stderr
+    interactor_stdout, interactor_stderr = interactor.communicate(timeout=5)
+
+    assert interactor.returncode == 0, interactor_stderr
+    assert interactor_stdout == "1.000000000\n"
+
+
 def test_spoj_file_descriptors(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
     paths = {
         "input": write(tmp_path / "input.txt", "7\n"),
@@ -124,6 +394,72 @@ def test_spoj_file_descriptors(fixture_dir: pathlib.Path, tmp_path: pathlib.Path
     assert "accepted" in paths["info"].read_text(encoding="utf-8")
 
 
+@pytest.mark.parametrize("source_kind", ["file", "pipe"])
+def test_spoj_c_api_fast_mode(fixture_dir: pathlib.Path, tmp_path: pathlib.Path, source_kind: str):
+    source_text = "int main() {}\n" * 10000
+    input_file = write(tmp_path / "input.txt", "100\n")
+    info = tmp_path / "info.txt"
+    source_file = write(tmp_path / "source.cpp", source_text)
+    to_contestant_read, to_contestant_write = os.pipe()
+    from_contestant_read, from_contestant_write = os.pipe()
+    source_read, source_write = os.pipe()
+
+    with (
+        input_file.open("rb") as problem_input,
+        write(tmp_path / "problem-output.txt", "").open("rb") as problem_output,
+        info.open("wb") as info_output,
+        (tmp_path / "user-info.txt").open("wb") as user_info,
+        (tmp_path / "score.txt").open("wb") as score,
+        source_file.open("rb") as source,
+    ):
+        mappings = {
+            0: problem_input.fileno(),
+            1: score.fileno(),
+            3: from_contestant_read,
+            4: problem_output.fileno(),
+            5: source.fileno() if source_kind == "file" else source_read,
+            6: info_output.fileno(),
+            7: user_info.fileno(),
+            8: to_contestant_write,
+        }
+        interactor = subprocess.Popen(
+            [
+                str(fixture_dir / "fd_launcher"),
+                str(fixture_dir / "spoj_interactive_fast"),
+                *(f"{fd}:{target}" for target, fd in mappings.items()),
+                "--",
+            ],
+            cwd=tmp_path,
+            pass_fds=tuple(mappings.values()),
+            stderr=subprocess.PIPE,
+        )
+    for fd in (from_contestant_read, to_contestant_write, source_read):
+        os.close(fd)
+
+    # The source is larger than a pipe holds, so it is fed while the interaction runs.
+    def feed_source():
+        with os.fdopen(source_write, "w") as writer:
+            if source_kind == "pipe":
+                writer.write(source_text)
+
+    feeder = threading.Thread(target=feed_source)
+    feeder.start()
+
+    # Every query must arrive before the interactor waits for its answer.
+    with (
+        os.fdopen(to_contestant_read) as reader,
+        os.fdopen(from_contestant_write, "w") as writer,
+    ):
+        for _ in range(100):
+            writer.write(f"{int(reader.readline()) + 1}\n")
+            writer.flush()
+    _, stderr = interactor.communicate(timeout=5)
+    feeder.join()
+
+    assert interactor.returncode == 0, stderr
+    assert info.read_text(encoding="utf-8") == f"{len(source_text)}\n"
+
+
 def test_two_step_phase_pair(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
     input_file = write(tmp_path / "input.txt", "7\n")
     report = tmp_path / "interaction-report.txt"
@@ -141,3 +477,103 @@ def test_two_step_phase_pair(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
         cwd=tmp_path,
     )
     assert checker.returncode == 0, checker.stderr
+
+
+@pytest.mark.parametrize(("response", "returncode"), [(7, 0), (6, 1)])
+def test_two_step_transcript_hook(
+    fixture_dir: pathlib.Path, tmp_path: pathlib.Path, response: int, returncode: int
+):
+    input_file = write(tmp_path / "input.txt", "7\n")
+    report = tmp_path / "interaction-report.txt"
+    phase_one, _ = interact_stdio(
+        fixture_dir / "interactor_two_step_transcript",
+        input_file,
+        report,
+        cwd=tmp_path,
+        response=response,
+    )
+
+    assert phase_one.returncode == 0, phase_one.stderr
+    assert report.read_bytes().startswith(b"\x89C2S")
+    checker = run(
+        fixture_dir / "checker_two_step_hooked",
+        input_file,
+        report,
+        write(tmp_path / "answer.txt", ""),
+        cwd=tmp_path,
+    )
+    assert checker.returncode == returncode, checker.stderr
+
+    # Without a hook, the interactor's verdict stands.
+    checker = run(
+        pathlib.Path(os.environ["CHECKER_TWO_STEP"]),
+        input_file,
+        report,
+        write(tmp_path / "answer.txt", ""),
+        cwd=tmp_path,
+    )
+    assert checker.returncode == 0, checker.stderr
+
+
+def test_two_step_report_formats(fixture_dir: pathlib.Path, tmp_path: pathlib.Path):
+    input_file = write(tmp_path / "input.txt", "7\n")
+    answer_file = write(tmp_path / "answer.txt", "")
+    report = tmp_path / "interaction-report.txt"
+    phase_one, _ = interact_stdio(
+        fixture_dir / "interactor_two_step",
+        input_file,
+        report,
+        cwd=tmp_path,
+        response=6,
+    )
+    assert phase_one.returncode == 0, phase_one.stderr
+    frame = report.read_bytes()
+    assert frame.startswith(b"\x89C2S")
+
+    def check() -> subprocess.CompletedProcess[str]:
+        checker = pathlib.Path(os.environ["CHECKER_TWO_STEP"])
+        return run(checker, input_file, report, answer_file, cwd=tmp_path)
+
+    result = check()
+    assert result.returncode == 1, result.stderr
+    assert "unexpected response" in result.stderr
+
+    # A corrupted frame fails the checksum.
+    report.write_bytes(frame[:-5] + bytes([frame[-5] ^ 1]) + frame[-4:])
+    result = check()
+    assert result.returncode == 1, result.stderr
+    assert "checksum" in result.stderr
+
+    # The frame is read from the whole file, so anything after it is rejected too.
+    report.write_bytes(frame + b"7\n")
+    result = check()
+    assert result.returncode == 1, result.stderr
+    assert "bad length or checksum" in result.stderr
+
+    # Text reports are still accepted: status 3 is partially correct.
+    message = base64.b64encode(b"half").decode()
+    write(report, f"3\n0.500000000\n{message}\n")
+    result = check()
+    assert result.returncode == 7, result.stderr
+    assert "half" in result.stderr
+
+
+@pytest.mark.parametrize("target", ["interactor_testlib", "interactor_coci_channel"])
+def test_profile(fixture_dir: pathlib.Path, tmp_path: pathlib.Path, target: str):
+    input_file = write(tmp_path / "input.txt", "7\n")
+    profile = tmp_path / "profile.jsonl"
+    env = {**os.environ, "CPLIB_INITIALIZERS_PROFILE": str(profile)}
+
+    result, ready = interact_stdio(
+        fixture_dir / target, input_file, cwd=tmp_path, env=env
+    )
+
+    assert ready == "ready\n"
+    assert result.returncode == 0, result.stderr
+    (record,) = [json.loads(line) for line in profile.read_text().splitlines()]
+    assert record["mode"] == "interactor"
+    assert record["exit_code"] == 0
+    assert record["phases_ns"]["evaluate"] is not None
+    assert record["streams"]["inf"]["bytes"] == 2
+    assert record["streams"]["from_user"]["bytes"] == 2
+    assert set(record["streams"]) == {"inf", "from_user"}
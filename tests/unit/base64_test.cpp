@@ -1,23 +1,86 @@
 #include <catch2/catch_test_macros.hpp>
-#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <random>
 #include <string>
 #include <vector>
 
-#include "testlib/interactor_two_step.hpp"
+#include "common/base64.hpp"
 
 namespace {
-using cplib_initializers::testlib::interactor_two_step::detail::base64_encode;
+namespace base64 = cplib_initializers::common::base64;
+using base64::Kernel;
 
-auto bytes(std::string value) -> std::vector<std::uint8_t> { return {value.begin(), value.end()}; }
+auto vector_kernels() -> std::vector<Kernel> {
+  std::vector<Kernel> kernels;
+  for (auto kernel : {Kernel::SSE41, Kernel::AVX2}) {
+    if (base64::supported(kernel)) kernels.push_back(kernel);
+  }
+  return kernels;
+}
+
+auto random_bytes(std::mt19937 &rng, std::size_t size) -> std::string {
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::string data(size, '\0');
+  for (auto &c : data) c = static_cast<char>(byte(rng));
+  return data;
+}
 }  // namespace
 
 TEST_CASE("two-step Base64 encoding handles complete and partial groups") {
-  CHECK(base64_encode(bytes("")) == "");
-  CHECK(base64_encode(bytes("f")) == "Zg==");
-  CHECK(base64_encode(bytes("fo")) == "Zm8=");
-  CHECK(base64_encode(bytes("foo")) == "Zm9v");
-  CHECK(base64_encode(bytes("foob")) == "Zm9vYg==");
-  CHECK(base64_encode(bytes("fooba")) == "Zm9vYmE=");
-  CHECK(base64_encode(bytes("foobar")) == "Zm9vYmFy");
-  CHECK(base64_encode(bytes("foobarb")) == "Zm9vYmFyYg==");
+  CHECK(base64::encode("") == "");
+  CHECK(base64::encode("f") == "Zg==");
+  CHECK(base64::encode("fo") == "Zm8=");
+  CHECK(base64::encode("foo") == "Zm9v");
+  CHECK(base64::encode("foob") == "Zm9vYg==");
+  CHECK(base64::encode("fooba") == "Zm9vYmE=");
+  CHECK(base64::encode("foobar") == "Zm9vYmFy");
+  CHECK(base64::encode("foobarb") == "Zm9vYmFyYg==");
+}
+
+TEST_CASE("two-step Base64 decoding accepts optional padding only at the end") {
+  CHECK(base64::decode("") == "");
+  CHECK(base64::decode("Zg==") == "f");
+  CHECK(base64::decode("Zg=") == "f");
+  CHECK(base64::decode("Zg") == "f");
+  CHECK(base64::decode("Zm8=") == "fo");
+  CHECK(base64::decode("Zm8") == "fo");
+  CHECK(base64::decode("Zm9vYmFy") == "foobar");
+  CHECK(base64::decode("+/+/") == std::string("\xfb\xff\xbf"));
+
+  CHECK(base64::decode("Z") == std::nullopt);
+  CHECK(base64::decode("Z==") == std::nullopt);
+  CHECK(base64::decode("Zm9vZ") == std::nullopt);
+  CHECK(base64::decode("Zg===") == std::nullopt);
+  CHECK(base64::decode("Z=g=") == std::nullopt);
+  CHECK(base64::decode("Zm9v-mFy") == std::nullopt);
+  CHECK(base64::decode("Zm9v YmFy") == std::nullopt);
+}
+
+TEST_CASE("two-step Base64 vector kernels match the scalar codec") {
+  std::mt19937 rng(20241018);
+  for (std::size_t size = 0; size < 200; ++size) {
+    const auto data = random_bytes(rng, size);
+    const auto encoded = base64::encode(data, Kernel::SCALAR);
+    REQUIRE(base64::decode(encoded, Kernel::SCALAR) == data);
+    for (auto kernel : vector_kernels()) {
+      CHECK(base64::encode(data, kernel) == encoded);
+      CHECK(base64::decode(encoded, kernel) == data);
+    }
+  }
+}
+
+TEST_CASE("two-step Base64 vector kernels reject every invalid character the scalar codec does") {
+  // Long enough for a full AVX2 block, with the character under test in each position.
+  const auto valid = base64::encode(std::string(48, 'x'));
+  for (int c = 0; c < 256; ++c) {
+    for (std::size_t pos = 0; pos < valid.size(); pos += 7) {
+      auto encoded = valid;
+      encoded[pos] = static_cast<char>(c);
+      const auto expected = base64::decode(encoded, Kernel::SCALAR);
+      for (auto kernel : vector_kernels()) {
+        CHECK(base64::decode(encoded, kernel) == expected);
+      }
+    }
+  }
 }
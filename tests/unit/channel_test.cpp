@@ -0,0 +1,296 @@
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <csignal>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "common/channel.hpp"
+
+namespace {
+using cplib_initializers::common::channel::FromUserBuf;
+using cplib_initializers::common::channel::Options;
+using cplib_initializers::common::channel::ToUserBuf;
+
+struct Pipe {
+  std::array<int, 2> fds{-1, -1};
+
+  Pipe() { REQUIRE(pipe(fds.data()) == 0); }
+  ~Pipe() {
+    for (auto fd : fds) {
+      if (fd >= 0) close(fd);
+    }
+  }
+
+  [[nodiscard]] auto readable() const -> bool {
+    pollfd entry{fds[0], POLLIN, 0};
+    return poll(&entry, 1, 0) == 1;
+  }
+
+  auto drain() const -> std::string {
+    std::string result;
+    while (readable()) {
+      std::array<char, 256> buffer{};
+      auto size = read(fds[0], buffer.data(), buffer.size());
+      if (size <= 0) break;
+      result.append(buffer.data(), static_cast<std::size_t>(size));
+    }
+    return result;
+  }
+};
+}  // namespace
+
+TEST_CASE("to_user flushes are deferred until from_user needs more data") {
+  Pipe to_user;
+  Pipe from_user;
+  const Options options{.coalesce = true};
+  ToUserBuf to_user_buf(to_user.fds[1], options);
+  FromUserBuf from_user_buf(from_user.fds[0], &to_user_buf, options);
+  std::ostream stream(&to_user_buf);
+
+  stream << "? 1" << std::endl << "? 2" << std::flush;
+  CHECK_FALSE(to_user.readable());
+
+  REQUIRE(write(from_user.fds[1], "7\n", 2) == 2);
+  CHECK(from_user_buf.sbumpc() == '7');
+  CHECK(to_user.drain() == "? 1\n? 2");
+
+  // Buffered input is consumed without touching the contestant channel.
+  stream << "? 3" << std::flush;
+  CHECK(from_user_buf.sbumpc() == '\n');
+  CHECK_FALSE(to_user.readable());
+}
+
+TEST_CASE("to_user is written out when its buffer fills") {
+  Pipe to_user;
+  ToUserBuf to_user_buf(to_user.fds[1], Options{.buffer_size = 4});
+  std::ostream stream(&to_user_buf);
+
+  stream << "abc";
+  CHECK_FALSE(to_user.readable());
+  stream << "de";
+  CHECK(to_user.drain() == "abc");
+  stream << "0123456789";
+  CHECK(to_user.drain() == "de0123456789");
+}
+
+TEST_CASE("to_user flushes immediately unless coalescing is enabled") {
+  Pipe to_user;
+  ToUserBuf to_user_buf(to_user.fds[1], Options{});
+  std::ostream stream(&to_user_buf);
+
+  stream << "ready" << std::flush;
+  CHECK(to_user.drain() == "ready");
+}
+
+TEST_CASE("to_user writes pending output when destroyed") {
+  Pipe to_user;
+  {
+    ToUserBuf to_user_buf(to_user.fds[1], Options{});
+    std::ostream stream(&to_user_buf);
+    stream << "bye\n";
+    CHECK_FALSE(to_user.readable());
+  }
+  CHECK(to_user.drain() == "bye\n");
+}
+
+TEST_CASE("busy-polling from_user adapts its spin phase to the response time") {
+  using namespace std::chrono_literals;
+  Pipe from_user;
+  FromUserBuf from_user_buf(from_user.fds[0], nullptr, Options{.spin_budget = 2ms});
+  CHECK(from_user_buf.spin_limit() == 2ms);
+
+  // A slow response falls back to poll and halves the spin phase.
+  std::thread writer([&] {
+    std::this_thread::sleep_for(20ms);
+    REQUIRE(write(from_user.fds[1], "1\n", 2) == 2);
+  });
+  CHECK(from_user_buf.sbumpc() == '1');
+  writer.join();
+  CHECK(from_user_buf.spin_limit() == 1ms);
+
+  // A prompt response keeps the spin phase short but non-zero.
+  REQUIRE(write(from_user.fds[1], "2", 1) == 1);
+  CHECK(from_user_buf.sbumpc() == '\n');
+  CHECK(from_user_buf.sbumpc() == '2');
+  CHECK(from_user_buf.spin_limit() > 0ms);
+  CHECK(from_user_buf.spin_limit() < 1ms);
+
+  close(from_user.fds[1]);
+  from_user.fds[1] = -1;
+  CHECK(from_user_buf.sgetc() == std::char_traits<char>::eof());
+}
+
+TEST_CASE("from_user reports an idle contestant after the idle timeout") {
+  using namespace std::chrono_literals;
+  Pipe to_user;
+  Pipe from_user;
+  ToUserBuf to_user_buf(to_user.fds[1], Options{});
+  FromUserBuf from_user_buf(from_user.fds[0], &to_user_buf, Options{.idle_timeout = 20ms});
+  std::chrono::milliseconds reported{0};
+  from_user_buf.set_idle_handler([&](std::chrono::milliseconds timeout) { reported = timeout; });
+
+  // The contestant waits for a query that never comes.
+  const auto contestant = fork();
+  REQUIRE(contestant >= 0);
+  if (contestant == 0) {
+    char query;
+    static_cast<void>(read(to_user.fds[0], &query, 1));
+    _exit(0);
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  CHECK(from_user_buf.sgetc() == std::char_traits<char>::eof());
+  CHECK(std::chrono::steady_clock::now() - start >= 20ms);
+  CHECK(reported == 20ms);
+  kill(contestant, SIGKILL);
+  waitpid(contestant, nullptr, 0);
+}
+
+TEST_CASE("from_user does not report a computing contestant as idle") {
+  using namespace std::chrono_literals;
+  Pipe to_user;
+  Pipe from_user;
+  ToUserBuf to_user_buf(to_user.fds[1], Options{});
+  FromUserBuf from_user_buf(from_user.fds[0], &to_user_buf, Options{.idle_timeout = 20ms});
+  bool idle = false;
+  from_user_buf.set_idle_handler([&](std::chrono::milliseconds) { idle = true; });
+
+  // The contestant computes for several idle timeouts before it answers.
+  const auto contestant = fork();
+  REQUIRE(contestant >= 0);
+  if (contestant == 0) {
+    const auto until = std::chrono::steady_clock::now() + 100ms;
+    while (std::chrono::steady_clock::now() < until) {
+    }
+    _exit(write(from_user.fds[1], "1\n", 2) == 2 ? 0 : 1);
+  }
+
+  CHECK(from_user_buf.sgetc() == '1');
+  CHECK_FALSE(idle);
+  waitpid(contestant, nullptr, 0);
+}
+
+TEST_CASE("from_user does not report a contestant that has unread input as idle") {
+  using namespace std::chrono_literals;
+  Pipe to_user;
+  Pipe from_user;
+  ToUserBuf to_user_buf(to_user.fds[1], Options{});
+  FromUserBuf from_user_buf(from_user.fds[0], &to_user_buf, Options{.idle_timeout = 20ms});
+  bool idle = false;
+  from_user_buf.set_idle_handler([&](std::chrono::milliseconds) { idle = true; });
+  std::ostream stream(&to_user_buf);
+
+  stream << "? 1\n";
+  std::thread contestant([&] {
+    std::this_thread::sleep_for(60ms);
+    CHECK(to_user.drain() == "? 1\n");
+    REQUIRE(write(from_user.fds[1], "1\n", 2) == 2);
+  });
+  CHECK(from_user_buf.sgetc() == '1');
+  contestant.join();
+  CHECK_FALSE(idle);
+}
+
+TEST_CASE("the to_user write queue keeps from_user readable while output is pending") {
+  Pipe to_user;
+  Pipe from_user;
+  const std::string query(1 << 20, 'q');
+  const std::string answer(1 << 20, 'a');
+
+  // Both sides send more than a pipe holds before reading, which deadlocks with blocking writes.
+  std::thread contestant([&] {
+    for (std::size_t sent = 0; sent < answer.size();) {
+      auto size = write(from_user.fds[1], answer.data() + sent, answer.size() - sent);
+      REQUIRE(size > 0);
+      sent += static_cast<std::size_t>(size);
+    }
+    std::string received;
+    std::array<char, 1 << 16> buffer{};
+    while (received.size() < query.size()) {
+      auto size = read(to_user.fds[0], buffer.data(), buffer.size());
+      REQUIRE(size > 0);
+      received.append(buffer.data(), static_cast<std::size_t>(size));
+    }
+    CHECK(received == query);
+  });
+
+  {
+    const Options options{.write_queue = true};
+    ToUserBuf to_user_buf(to_user.fds[1], options);
+    FromUserBuf from_user_buf(from_user.fds[0], &to_user_buf, options);
+    std::ostream stream(&to_user_buf);
+
+    stream << query << std::flush;
+    for (auto ch : answer) REQUIRE(from_user_buf.sbumpc() == ch);
+  }
+  contestant.join();
+}
+
+namespace {
+// A temporary file holding `content`, removed when the test ends.
+struct TempFile {
+  std::string path = "/tmp/cplib-channel-test-XXXXXX";
+  int fd;
+
+  explicit TempFile(std::string_view content) : fd(mkstemp(path.data())) {
+    REQUIRE(fd >= 0);
+    REQUIRE(write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size()));
+  }
+  ~TempFile() {
+    close(fd);
+    unlink(path.c_str());
+  }
+};
+}  // namespace
+
+TEST_CASE("file data is forwarded to to_user in order with buffered output") {
+  namespace channel = cplib_initializers::common::channel;
+  Pipe to_user;
+  TempFile file("0123456789");
+  ToUserBuf to_user_buf(to_user.fds[1], Options{});
+  std::ostream stream(&to_user_buf);
+
+  stream << "head ";
+  CHECK(channel::forward(stream, file.fd, 2, 5));
+  stream << " tail";
+  CHECK(to_user.drain() == "head 23456");
+  to_user_buf.flush();
+  CHECK(to_user.drain() == " tail");
+
+  CHECK(channel::forward_file(stream, file.path, 8));
+  CHECK(to_user.drain() == "89");
+}
+
+TEST_CASE("forwarded file data is recorded in the transcript") {
+  namespace channel = cplib_initializers::common::channel;
+  Pipe to_user;
+  TempFile file("0123456789");
+  TempFile transcript("");
+  {
+    ToUserBuf to_user_buf(to_user.fds[1], Options{.record_path = transcript.path});
+    std::ostream stream(&to_user_buf);
+    stream << "> ";
+    CHECK(channel::forward_file(stream, file.path));
+  }
+  CHECK(to_user.drain() == "> 0123456789");
+
+  const auto loaded = cplib_initializers::common::transcript::load(transcript.path);
+  REQUIRE(loaded.has_value());
+  CHECK(loaded->to_user == "> 0123456789");
+}
+
+TEST_CASE("file data is copied to streams that are not a channel") {
+  namespace channel = cplib_initializers::common::channel;
+  TempFile file("0123456789");
+  std::ostringstream stream;
+  CHECK(channel::forward(stream, file.fd, 7, 10));
+  CHECK(stream.str() == "789");
+}
@@ -0,0 +1,32 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <random>
+#include <string>
+
+#include "common/compress.hpp"
+
+namespace compress = cplib_initializers::common::compress;
+
+TEST_CASE("compression round-trips repetitive and random data") {
+  std::string rounds;
+  for (int i = 0; i < 100000; ++i) rounds += "? " + std::to_string(i % 97) + "\n= 1\n";
+  const auto packed = compress::compress(rounds);
+  CHECK(packed.size() * 10 < rounds.size());
+  CHECK(compress::decompress(packed) == rounds);
+
+  std::mt19937 rng(7);
+  for (std::size_t size : {0, 1, 3, 4, 5, 1000, 1 << 20, (1 << 20) + 17}) {
+    std::string data(size, '\0');
+    for (auto &c : data) c = static_cast<char>(rng() % 4);
+    CHECK(compress::decompress(compress::compress(data)) == data);
+  }
+}
+
+TEST_CASE("decompression rejects corrupt input") {
+  const auto packed = compress::compress(std::string(1000, 'a') + "b");
+  CHECK_FALSE(compress::decompress(packed.substr(0, packed.size() - 1)).has_value());
+  CHECK_FALSE(compress::decompress(packed + "x").has_value());
+
+  // One literal 'a', then a match reaching before the start of the block.
+  CHECK_FALSE(compress::decompress(std::string("\x05\x04\x01" "a\x04\x02")).has_value());
+}
@@ -0,0 +1,174 @@
+#include <unistd.h>
+
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "coci/interactor.hpp"
+#include "common/channel.hpp"
+#include "common/coroutine.hpp"
+#include "cplib.hpp"
+
+namespace {
+using cplib_initializers::common::channel::Channel;
+using cplib_initializers::common::channel::FromUserBuf;
+using cplib_initializers::common::channel::Options;
+using cplib_initializers::common::coroutine::line_ready;
+using cplib_initializers::common::coroutine::read;
+using cplib_initializers::common::coroutine::Runtime;
+using cplib_initializers::common::coroutine::Task;
+using cplib_initializers::common::coroutine::yield;
+
+struct Pipe {
+  std::array<int, 2> fds{-1, -1};
+
+  Pipe() { REQUIRE(pipe(fds.data()) == 0); }
+  ~Pipe() {
+    for (auto fd : fds) {
+      if (fd >= 0) close(fd);
+    }
+  }
+};
+
+auto read_line(FromUserBuf &buf) -> std::string {
+  std::string line;
+  for (auto ch = buf.sbumpc(); ch != '\n'; ch = buf.sbumpc()) {
+    line.push_back(static_cast<char>(ch));
+  }
+  return line;
+}
+
+auto converse(FromUserBuf &buf, std::string name, std::vector<std::string> &log) -> Task<> {
+  co_await line_ready(buf);
+  log.push_back(name + ": " + read_line(buf));
+}
+
+auto count_in_background(int &steps, const bool &stop) -> Task<> {
+  while (!stop) {
+    ++steps;
+    co_await yield();
+  }
+}
+
+auto stop_on_line(FromUserBuf &buf, bool &stop) -> Task<> {
+  co_await line_ready(buf);
+  stop = true;
+}
+
+// Ask `rounds` queries, recording each answer and how far the background task got meanwhile.
+auto ask(cplib::var::Reader &from_user, std::ostream &to_user, int rounds, const int &steps,
+         std::vector<std::pair<int, int>> &answers, bool &stop) -> Task<> {
+  for (int round = 1; round <= rounds; ++round) {
+    to_user << round << '\n';
+    const auto answer = co_await read(from_user, cplib::var::i32("answer"));
+    answers.emplace_back(answer, steps);
+  }
+  stop = true;
+}
+
+auto twice(int value) -> Task<int> { co_return value * 2; }
+
+auto store_twice(int value, int &result) -> Task<> { result = co_await twice(value); }
+
+auto fail() -> Task<int> {
+  throw std::runtime_error("failed");
+  co_return 0;
+}
+
+auto await_failure() -> Task<> { co_await fail(); }
+}  // namespace
+
+TEST_CASE("tasks awaiting different channels are resumed in arrival order") {
+  Pipe first;
+  Pipe second;
+  FromUserBuf first_buf(first.fds[0], nullptr, Options{});
+  FromUserBuf second_buf(second.fds[0], nullptr, Options{});
+  std::vector<std::string> log;
+  int steps = 0;
+  bool stop = false;
+
+  bool written = true;
+  std::thread contestants([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    written = written && write(second.fds[1], "2", 1) == 1;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    written = written && write(second.fds[1], "2\n", 2) == 2;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    written = written && write(first.fds[1], "11\n", 3) == 3;
+  });
+
+  Runtime runtime;
+  runtime.spawn(converse(first_buf, "first", log));
+  runtime.spawn(converse(second_buf, "second", log));
+  runtime.spawn(stop_on_line(first_buf, stop));
+  runtime.spawn(count_in_background(steps, stop));
+  runtime.run();
+  contestants.join();
+
+  CHECK(written);
+  CHECK(log == std::vector<std::string>{"second: 22", "first: 11"});
+  CHECK(steps > 1);
+}
+
+TEST_CASE("read awaits each round instead of blocking on the previous line break") {
+  Pipe from_user;
+  Pipe to_user;
+  cplib::interactor::State state(
+      std::make_unique<cplib_initializers::coci::interactor::Initializer>());
+  Channel channel(state, from_user.fds[0], to_user.fds[1], "contestant",
+                  cplib::trace::Level::NONE, Options{});
+  std::vector<std::pair<int, int>> answers;
+  int steps = 0;
+  bool stop = false;
+
+  // The contestant doubles every query after thinking about it for a while.
+  bool answered = true;
+  std::thread contestant([&] {
+    std::string query;
+    for (int round = 1; round <= 3; ++round) {
+      char ch;
+      query.clear();
+      while (read(to_user.fds[0], &ch, 1) == 1 && ch != '\n') query.push_back(ch);
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      const auto answer = std::to_string(std::stoi(query) * 2) + "\n";
+      answered = answered && write(from_user.fds[1], answer.data(), answer.size()) ==
+                                 static_cast<ssize_t>(answer.size());
+    }
+  });
+
+  Runtime runtime;
+  runtime.spawn(ask(channel.from_user(), channel.to_user(), 3, steps, answers, stop));
+  runtime.spawn(count_in_background(steps, stop));
+  runtime.run();
+  contestant.join();
+
+  CHECK(answered);
+  REQUIRE(answers.size() == 3);
+  int previous_steps = 0;
+  for (int round = 1; round <= 3; ++round) {
+    const auto [answer, steps_at_answer] = answers[round - 1];
+    CHECK(answer == round * 2);
+    // The background task ran while the round was awaited.
+    CHECK(steps_at_answer > previous_steps);
+    previous_steps = steps_at_answer;
+  }
+}
+
+TEST_CASE("awaited tasks return values and propagate exceptions") {
+  int result = 0;
+  Runtime runtime;
+  runtime.spawn(store_twice(21, result));
+  runtime.run();
+  CHECK(result == 42);
+
+  Runtime failing;
+  failing.spawn(await_failure());
+  CHECK_THROWS_AS(failing.run(), std::runtime_error);
+}
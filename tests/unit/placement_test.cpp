@@ -0,0 +1,50 @@
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+#include "common/placement.hpp"
+
+namespace placement = cplib_initializers::common::placement;
+
+TEST_CASE("cpu lists are parsed from sysfs notation") {
+  CHECK(placement::detail::parse_cpu_list("0-1,8") == std::vector{0, 1, 8});
+  CHECK(placement::detail::parse_cpu_list("3") == std::vector{3});
+  CHECK(placement::detail::parse_cpu_list("1-x").empty());
+}
+
+TEST_CASE("the contestant is found at the other end of a pipe") {
+  std::array<int, 2> fds{};
+  REQUIRE(pipe(fds.data()) == 0);
+  const auto child = fork();
+  if (child == 0) {
+    close(fds[1]);
+    char ch;
+    _exit(static_cast<int>(read(fds[0], &ch, 1)));
+  }
+  close(fds[0]);
+
+  CHECK(placement::detail::peer_pid(fds[1]) == child);
+  const auto cpu = placement::detail::last_cpu(child);
+  REQUIRE(cpu.has_value());
+  CHECK(*cpu >= 0);
+
+  close(fds[1]);
+  waitpid(child, nullptr, 0);
+}
+
+TEST_CASE("the interactor is pinned to the requested cpu") {
+  cpu_set_t original;
+  REQUIRE(sched_getaffinity(0, sizeof(original), &original) == 0);
+  int allowed = 0;
+  while (!CPU_ISSET(allowed, &original)) ++allowed;
+
+  CHECK(placement::apply({.cpu = allowed}, -1));
+  CHECK(sched_getcpu() == allowed);
+  CHECK_FALSE(placement::apply({.cpu = CPU_SETSIZE}, -1));
+
+  REQUIRE(sched_setaffinity(0, sizeof(original), &original) == 0);
+}
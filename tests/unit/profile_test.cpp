@@ -0,0 +1,88 @@
+#include <unistd.h>
+
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <optional>
+#include <string>
+
+#include "common/profile.hpp"
+
+namespace profile = cplib_initializers::common::profile;
+
+TEST_CASE("profile records render each phase as a span") {
+  profile::Record record{
+      .mode = "checker",
+      .exec_ns = 5,
+      .init_ns = 10,
+      .first_open_ns = 15,
+      .opened_ns = 20,
+      .report_ns = 60,
+      .reported_ns = 70,
+      .flushed_ns = 71,
+      .streams = {},
+      .read_counters = std::nullopt,
+      .evaluate_counters = profile::Counters{100},
+      .exit_code = 1,
+  };
+  record.streams[0] = {.opened = true, .bytes = 2, .first_read_ns = 30, .last_read_ns = 35};
+  record.streams[2] = {.opened = true, .bytes = 3, .first_read_ns = 25, .last_read_ns = 40};
+
+  CHECK(profile::to_json(record) ==
+        R"({"version":1,"mode":"checker","exit_code":1,"phases_ns":{"exec":5,"static_init":10,)"
+        R"("args":5,"open":5,"read":15,"evaluate":20,"report":10,"report_io":1},"streams":{)"
+        R"("inf":{"bytes":2,"first_read_ns":30,"last_read_ns":35},)"
+        R"("ans":{"bytes":3,"first_read_ns":25,"last_read_ns":40}},"counters":{"read":null,)"
+        R"("evaluate":{"cycles":100,"instructions":null,"cache_misses":null,)"
+        R"("branch_misses":null}}})"
+        "\n");
+}
+
+TEST_CASE("profile records leave phases that were not reached null") {
+  profile::Record record{};
+  record.mode = "interactor";
+  record.init_ns = 10;
+  CHECK(profile::to_json(record) ==
+        R"({"version":1,"mode":"interactor","exit_code":0,"phases_ns":{"exec":null,)"
+        R"("static_init":10,"args":null,"open":null,"read":null,"evaluate":null,"report":null,)"
+        R"("report_io":null},"streams":{},"counters":{"read":null,"evaluate":null}})"
+        "\n");
+}
+
+TEST_CASE("counter differences skip counters missing at either end") {
+  const profile::Counters from{10, std::nullopt, 5, 7};
+  const profile::Counters to{25, 3, std::nullopt, 7};
+  CHECK(profile::detail::difference(from, to) ==
+        profile::Counters{15, std::nullopt, std::nullopt, 0});
+}
+
+TEST_CASE("perf groups either count or report nothing") {
+  const profile::detail::PerfGroup group;
+  const auto first = group.read();
+  volatile std::uint64_t sink = 0;
+  for (std::uint64_t i = 0; i < 1'000'000; ++i) sink = sink + i;
+  const auto second = group.read();
+  REQUIRE(first.has_value() == second.has_value());
+  if (second && (*second)[1]) CHECK(*(*second)[1] > *(*first)[1]);
+}
+
+TEST_CASE("CountingBuf counts the bytes it reads") {
+  std::array<int, 2> fds{};
+  REQUIRE(pipe(fds.data()) == 0);
+  const std::string data(60'000, 'x');
+  REQUIRE(write(fds[1], data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+  close(fds[1]);
+
+  const auto &record = profile::detail::record.streams[0];
+  profile::detail::CountingBuf buf(fds[0], true, profile::Stream::INF);
+  std::istream in(&buf);
+  const std::string read((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+  CHECK(read == data);
+  CHECK(record.bytes == data.size());
+  REQUIRE(record.first_read_ns.has_value());
+  REQUIRE(record.last_read_ns.has_value());
+  CHECK(*record.first_read_ns <= *record.last_read_ns);
+}
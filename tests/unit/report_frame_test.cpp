@@ -0,0 +1,47 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "common/crc32c.hpp"
+#include "common/report_frame.hpp"
+
+namespace crc32c = cplib_initializers::common::crc32c;
+namespace report_frame = cplib_initializers::common::report_frame;
+
+TEST_CASE("CRC-32C matches the reference value and the table implementation") {
+  CHECK(crc32c::compute("") == 0);
+  CHECK(crc32c::compute("123456789") == 0xe3069283);
+
+  std::mt19937 rng(3);
+  for (std::size_t size = 0; size < 100; ++size) {
+    std::string data(size, '\0');
+    for (auto &c : data) c = static_cast<char>(rng());
+    const auto *bytes = reinterpret_cast<const unsigned char *>(data.data());
+    CHECK(crc32c::compute(data) == ~crc32c::detail::update_scalar(~0U, bytes, size));
+  }
+}
+
+TEST_CASE("report frames round-trip and reject corruption") {
+  const std::string message("partial\0credit", 14);
+  const auto data = report_frame::encode(
+      {.status = 3, .score = 0.1, .message = message, .attachment = "compressed"});
+  CHECK(report_frame::is_frame(data));
+  CHECK_FALSE(report_frame::is_frame("1\n1.000000000\n\n"));
+
+  const auto frame = report_frame::decode(data);
+  REQUIRE(frame.has_value());
+  CHECK(frame->status == 3);
+  CHECK(frame->score == 0.1);
+  CHECK(frame->message == message);
+  CHECK(frame->attachment == "compressed");
+
+  for (std::size_t pos = 0; pos < data.size(); ++pos) {
+    auto corrupted = data;
+    corrupted[pos] = static_cast<char>(corrupted[pos] ^ 0x10);
+    CHECK_FALSE(report_frame::decode(corrupted).has_value());
+  }
+  CHECK_FALSE(report_frame::decode(data.substr(0, data.size() - 1)).has_value());
+  CHECK_FALSE(report_frame::decode(data + '\n').has_value());
+}
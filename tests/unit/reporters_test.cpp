@@ -7,6 +7,7 @@
 
 #include "coci/interactor.hpp"
 #include "cplib.hpp"
+#include "hustoj/checker.hpp"
 #include "syzoj/interactor.hpp"
 #include "testlib/interactor_two_step.hpp"
 #include "testlib/validator.hpp"
@@ -25,6 +26,20 @@ TEST_CASE("COCI interactor maps supported results to platform exit codes") {
         static_cast<int>(interactor::ExitCode::INTERNAL_ERROR));
 }
 
+TEST_CASE("HustOJ checker reports by the rule early exit stops by") {
+  namespace checker = cplib_initializers::hustoj::checker;
+  using Status = cplib::evaluate::Result::Status;
+  checker::Reporter reporter;
+  const auto accepted = static_cast<int>(checker::ExitCode::ACCEPTED);
+
+  CHECK(reporter.report({cplib::checker::Report::Status::PARTIALLY_CORRECT, 1.0, ""}) == accepted);
+  CHECK(reporter.report({cplib::checker::Report::Status::PARTIALLY_CORRECT, 0.5, ""}) != accepted);
+  CHECK(cplib_initializers::common::checker::counts_as_accepted(Status::PARTIALLY_CORRECT, 1.0));
+  CHECK_FALSE(
+      cplib_initializers::common::checker::counts_as_accepted(Status::PARTIALLY_CORRECT, 0.5));
+  CHECK(cplib_initializers::common::checker::counts_as_accepted(Status::ACCEPTED, 0.0));
+}
+
 TEST_CASE("two-step reporter returns internal error when its output cannot be opened") {
   namespace two_step = cplib_initializers::testlib::interactor_two_step;
   two_step::Reporter reporter("/definitely/missing/cplib-initializers/report.txt");
@@ -0,0 +1,90 @@
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "common/server.hpp"
+
+namespace server = cplib_initializers::common::server;
+
+namespace {
+// Run a session, waiting for the server to come up first.
+auto run_session(const std::string &socket_path, const std::array<int, 3> &fds)
+    -> std::optional<std::int32_t> {
+  for (int attempt = 0; attempt < 500; ++attempt) {
+    if (auto code = server::run_session(socket_path, fds)) return code;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return std::nullopt;
+}
+
+auto read_output(int fd) -> std::string {
+  std::string output;
+  std::array<char, 256> buffer{};
+  ssize_t size;
+  while ((size = read(fd, buffer.data(), buffer.size())) > 0) output.append(buffer.data(), size);
+  close(fd);
+  return output;
+}
+}  // namespace
+
+TEST_CASE("sessions start warm and read inputs from the start") {
+  const auto socket_path = "/tmp/cplib-server-test-" + std::to_string(getpid()) + ".sock";
+  char input_path[] = "/tmp/cplib-server-test-XXXXXX";
+  const auto input_fd = mkstemp(input_path);
+  REQUIRE(input_fd >= 0);
+  REQUIRE(write(input_fd, "input\n", 6) == 6);
+  close(input_fd);
+
+  const auto server_pid = fork();
+  if (server_pid == 0) {
+    // The server is stopped with SIGTERM, which Catch's handler would report as a failure.
+    signal(SIGTERM, SIG_DFL);
+    const auto inf = open(input_path, O_RDONLY);
+    int warm = 0;
+    if (!server::serve({.socket_path = socket_path, .warmup = [&warm] { warm = 42; }},
+                       {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO})) {
+      _exit(1);
+    }
+    std::array<char, 6> line{};
+    const auto size = read(inf, line.data(), line.size());
+    const auto output = std::to_string(warm) + " " + std::string(line.data(), size);
+    _exit(write(STDOUT_FILENO, output.data(), output.size()) < 0 ? 1 : 4);
+  }
+
+  for (int session = 0; session < 2; ++session) {
+    std::array<int, 2> out{};
+    std::array<int, 2> in{};
+    REQUIRE(pipe(out.data()) == 0);
+    REQUIRE(pipe(in.data()) == 0);
+    const auto report = dup(STDERR_FILENO);
+
+    const auto code = run_session(socket_path, {in[0], out[1], report});
+    close(in[1]);
+    close(report);
+    CHECK(code == 4);
+    CHECK(read_output(out[0]) == "42 input\n");
+  }
+
+  kill(server_pid, SIGTERM);
+  waitpid(server_pid, nullptr, 0);
+  unlink(socket_path.c_str());
+  unlink(input_path);
+}
+
+TEST_CASE("a missing server yields no session") {
+  std::array<int, 2> fds{};
+  REQUIRE(pipe(fds.data()) == 0);
+  CHECK_FALSE(server::run_session("/nonexistent/cplib.sock", {fds[0], fds[1], STDERR_FILENO}));
+  close(fds[0]);
+  close(fds[1]);
+}
@@ -0,0 +1,120 @@
+#include <unistd.h>
+
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <ostream>
+#include <string>
+
+#include "common/channel.hpp"
+#include "common/tracer.hpp"
+
+namespace {
+using cplib_initializers::common::tracer::decode;
+using cplib_initializers::common::tracer::encode;
+using cplib_initializers::common::tracer::Event;
+using cplib_initializers::common::tracer::EVENT_SIZE;
+using cplib_initializers::common::tracer::EventKind;
+using cplib_initializers::common::tracer::Histogram;
+using cplib_initializers::common::tracer::MAGIC;
+using cplib_initializers::common::tracer::Summary;
+
+auto read_file(const std::filesystem::path &path) -> std::string {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+}  // namespace
+
+TEST_CASE("trace events round-trip through the binary encoding") {
+  const Event event{
+      .time_ns = 0x0102030405060708,
+      .cpu_ns = 42,
+      .bytes = 0xfffffffe,
+      .kind = EventKind::FROM_USER,
+  };
+  std::string data(MAGIC);
+  data.resize(MAGIC.size() + EVENT_SIZE);
+  encode(event, data.data() + MAGIC.size());
+
+  const auto events = decode(data);
+  REQUIRE(events.has_value());
+  REQUIRE(events->size() == 1);
+  CHECK(events->front().time_ns == event.time_ns);
+  CHECK(events->front().cpu_ns == event.cpu_ns);
+  CHECK(events->front().bytes == event.bytes);
+  CHECK(events->front().kind == event.kind);
+
+  CHECK_FALSE(decode("CPLIBTR0").has_value());
+  CHECK_FALSE(decode(data.substr(0, data.size() - 1)).has_value());
+}
+
+TEST_CASE("histogram percentiles are bucket upper bounds within 12.5%") {
+  Histogram histogram;
+  for (std::uint64_t i = 1; i <= 1000; ++i) histogram.add(i * 1000);
+
+  CHECK(histogram.count() == 1000);
+  CHECK(histogram.max() == 1'000'000);
+  const auto p50 = histogram.percentile(0.5);
+  CHECK(p50 >= 500'000);
+  CHECK(p50 <= 500'000 * 9 / 8);
+  CHECK(histogram.percentile(1.0) == 1'000'000);
+  CHECK(Histogram{}.percentile(0.5) == 0);
+
+  Histogram small;
+  for (std::uint64_t i = 0; i < 8; ++i) small.add(i);
+  CHECK(small.percentile(0.0) == 0);
+  CHECK(small.rows().size() == 8);
+}
+
+TEST_CASE("a round spans the first to_user write to the next from_user arrival") {
+  Summary summary;
+  summary.add({.time_ns = 100, .cpu_ns = 10, .bytes = 4, .kind = EventKind::TO_USER});
+  summary.add({.time_ns = 150, .cpu_ns = 15, .bytes = 4, .kind = EventKind::TO_USER});
+  summary.add({.time_ns = 1100, .cpu_ns = 20, .bytes = 2, .kind = EventKind::FROM_USER});
+  summary.add({.time_ns = 1200, .cpu_ns = 25, .bytes = 2, .kind = EventKind::FROM_USER});
+  summary.add({.time_ns = 2000, .cpu_ns = 40, .bytes = 4, .kind = EventKind::TO_USER});
+  summary.add({.time_ns = 2003, .cpu_ns = 41, .bytes = 2, .kind = EventKind::FROM_USER});
+
+  CHECK(summary.latency().count() == 2);
+  CHECK(summary.latency().max() == 1000);
+  CHECK(summary.latency().percentile(0.0) == 3);
+}
+
+TEST_CASE("the contestant channel records its writes and reads") {
+  using cplib_initializers::common::channel::FromUserBuf;
+  using cplib_initializers::common::channel::Options;
+  using cplib_initializers::common::channel::ToUserBuf;
+
+  const auto path = std::filesystem::temp_directory_path() /
+                    ("cplib_tracer_test_" + std::to_string(getpid()));
+  std::array<int, 2> to_user{};
+  std::array<int, 2> from_user{};
+  REQUIRE(pipe(to_user.data()) == 0);
+  REQUIRE(pipe(from_user.data()) == 0);
+  {
+    ToUserBuf to_user_buf(to_user[1], Options{.trace_path = path.string()});
+    FromUserBuf from_user_buf(from_user[0], &to_user_buf, Options{});
+    std::ostream stream(&to_user_buf);
+
+    stream << "? 1\n" << std::flush;
+    REQUIRE(write(from_user[1], "7\n", 2) == 2);
+    CHECK(from_user_buf.sbumpc() == '7');
+  }
+  for (auto fd : {to_user[0], to_user[1], from_user[0], from_user[1]}) close(fd);
+
+  const auto events = decode(read_file(path));
+  REQUIRE(events.has_value());
+  REQUIRE(events->size() == 2);
+  CHECK((*events)[0].kind == EventKind::TO_USER);
+  CHECK((*events)[0].bytes == 4);
+  CHECK((*events)[1].kind == EventKind::FROM_USER);
+  CHECK((*events)[1].bytes == 2);
+  CHECK(read_file(path.string() + ".summary").starts_with("rounds: 1\n"));
+
+  std::filesystem::remove(path);
+  std::filesystem::remove(path.string() + ".summary");
+}
@@ -0,0 +1,56 @@
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+#include "common/transcript.hpp"
+
+namespace transcript = cplib_initializers::common::transcript;
+
+TEST_CASE("transcripts keep both streams across chunks") {
+  std::string data(transcript::MAGIC);
+  transcript::encode_chunk(transcript::ChunkKind::TO_USER, "? 1\n", data);
+  transcript::encode_chunk(transcript::ChunkKind::FROM_USER, "4", data);
+  transcript::encode_chunk(transcript::ChunkKind::FROM_USER, "2\n", data);
+  transcript::encode_chunk(transcript::ChunkKind::TO_USER, std::string(300, 'x'), data);
+  transcript::encode_chunk(transcript::ChunkKind::FROM_USER_EOF, "", data);
+
+  const auto decoded = transcript::decode(data);
+  REQUIRE(decoded.has_value());
+  CHECK(decoded->to_user == "? 1\n" + std::string(300, 'x'));
+  CHECK(decoded->from_user == "42\n");
+  CHECK(decoded->from_user_eof);
+
+  CHECK_FALSE(transcript::decode("CPLIBRR0").has_value());
+  CHECK_FALSE(transcript::decode(data.substr(0, data.size() - 3)).has_value());
+}
+
+TEST_CASE("a replay serves from_user and checks to_user") {
+  transcript::Replay replay(
+      {.to_user = "? 1\n? 2\n", .from_user = "1\n2\n", .from_user_eof = false, .state = {}});
+  std::string buffer(3, '\0');
+
+  CHECK(replay.expect("? 1\n"));
+  CHECK(replay.read(buffer.data(), buffer.size()) == 3);
+  CHECK(buffer == "1\n2");
+  CHECK_FALSE(replay.expect("? 3\n"));
+  CHECK(replay.expect("? 2\n"));
+  CHECK_FALSE(replay.expect("\n"));
+  CHECK(replay.read(buffer.data(), buffer.size()) == 1);
+  CHECK(replay.read(buffer.data(), buffer.size()) == 0);
+  CHECK_FALSE(replay.from_user_eof());
+}
+
+TEST_CASE("a recorder can keep the transcript in memory") {
+  transcript::Recorder recorder("", true);
+  recorder.record(transcript::ChunkKind::TO_USER, "? 1\n");
+  recorder.record(transcript::ChunkKind::FROM_USER, "1\n");
+  recorder.record(transcript::ChunkKind::STATE, "seed 5");
+  CHECK_FALSE(recorder.is_open());
+  recorder.finish();
+  recorder.record(transcript::ChunkKind::TO_USER, "ignored");
+
+  const auto decoded = transcript::decode(recorder.kept());
+  REQUIRE(decoded.has_value());
+  CHECK(decoded->to_user == "? 1\n");
+  CHECK(decoded->from_user == "1\n");
+  CHECK(decoded->state == "seed 5");
+}
@@ -0,0 +1,43 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include "common/tracer.hpp"
+
+namespace tracer = cplib_initializers::common::tracer;
+
+auto main(int argc, char **argv) -> int {
+  const bool print_events = argc == 3 && std::string_view(argv[2]) == "--events";
+  if (argc != 2 && !print_events) {
+    std::fputs("usage: decode_interaction_trace <trace_file> [--events]\n", stderr);
+    return EXIT_FAILURE;
+  }
+
+  std::ifstream file(argv[1], std::ios::binary);
+  if (!file) {
+    std::fprintf(stderr, "cannot open %s\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  const std::string data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+  const auto events = tracer::decode(data);
+  if (!events.has_value()) {
+    std::fprintf(stderr, "%s is not an interaction trace\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  tracer::Summary summary;
+  for (const auto &event : *events) {
+    summary.add(event);
+    if (print_events) {
+      std::printf("%14.3f us  cpu %14.3f us  %-9s %u bytes\n",
+                  static_cast<double>(event.time_ns) / 1000.0,
+                  static_cast<double>(event.cpu_ns) / 1000.0,
+                  event.kind == tracer::EventKind::TO_USER ? "to_user" : "from_user", event.bytes);
+    }
+  }
+  std::fputs(summary.to_string().c_str(), stdout);
+}
@@ -0,0 +1,28 @@
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "common/server.hpp"
+
+namespace server = cplib_initializers::common::server;
+
+// Exit code when no session could be run, distinct from the codes interactors report.
+constexpr int CLIENT_ERROR = 125;
+
+// Stands in for the interactor command of a judge: runs a session on a warm interactor server with
+// this process's stdin, stdout and stderr, and exits with the session's exit code.
+auto main(int argc, char **argv) -> int {
+  if (argc != 2) {
+    std::fputs("usage: interactor_client <socket_path>\n", stderr);
+    return CLIENT_ERROR;
+  }
+
+  const auto code = server::run_session(argv[1], {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO});
+  if (!code.has_value()) {
+    std::fprintf(stderr, "interactor_client: no session on %s\n", argv[1]);
+    return CLIENT_ERROR;
+  }
+  return *code;
+}